@@ -0,0 +1,215 @@
+/** Nota: mi cabecera debe ir antes que nada */
+#include "adaptativo.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Cantidad maxima de nodos: una hoja por simbolo, NYT y los internos */
+#define ADAPTATIVO_NODOS (2 * ADAPTATIVO_SIMBOLOS + 1)
+
+/* Bits con los que se escribe un simbolo nuevo */
+#define SIMBOLO_BITS 9
+
+/* Indica que un nodo no tiene hijo, padre o simbolo */
+#define NINGUNO (-1)
+
+/*
+  Los nodos estan numerados por su posicion en los arreglos, y la raiz es
+  el ultimo. Se mantiene la propiedad de hermanos: el peso no disminuye
+  con el numero y los hermanos son vecinos, asi que todos los nodos de
+  un mismo peso forman un bloque contiguo.
+*/
+struct _Adaptativo {
+    uint64_t peso[ADAPTATIVO_NODOS];
+    int padre[ADAPTATIVO_NODOS];
+    int izq[ADAPTATIVO_NODOS];      /* NINGUNO si es hoja */
+    int der[ADAPTATIVO_NODOS];
+    int simbolo[ADAPTATIVO_NODOS];  /* NINGUNO si no es una hoja de simbolo */
+    int hoja[ADAPTATIVO_SIMBOLOS];  /* nodo de cada simbolo, o NINGUNO */
+    int nyt;
+};
+
+Adaptativo adaptativo_crear(void) {
+    struct _Adaptativo* a = (struct _Adaptativo*) malloc(sizeof(struct _Adaptativo));
+    int i;
+
+    if (!a) {
+        return NULL;
+    }
+    for (i = 0; i < ADAPTATIVO_SIMBOLOS; i++) {
+        a->hoja[i] = NINGUNO;
+    }
+    a->nyt = ADAPTATIVO_NODOS - 1;
+    a->peso[a->nyt] = 0;
+    a->padre[a->nyt] = NINGUNO;
+    a->izq[a->nyt] = NINGUNO;
+    a->der[a->nyt] = NINGUNO;
+    a->simbolo[a->nyt] = NINGUNO;
+    return a;
+}
+
+void adaptativo_destruir(Adaptativo a) {
+    free(a);
+}
+
+/* Intercambia los subarboles de los nodos x e y, que tienen el mismo
+   peso y ninguno es antecesor del otro. Cada uno queda en el lugar del
+   otro con su numero, asi que solo cambia lo que cuelga de ellos. */
+static void intercambiar(struct _Adaptativo* a, int x, int y) {
+    int simbolo = a->simbolo[x];
+    int izq = a->izq[x];
+    int der = a->der[x];
+    int k;
+
+    a->simbolo[x] = a->simbolo[y];
+    a->izq[x] = a->izq[y];
+    a->der[x] = a->der[y];
+    a->simbolo[y] = simbolo;
+    a->izq[y] = izq;
+    a->der[y] = der;
+
+    for (k = 0; k < 2; k++) {
+        int n = k == 0 ? x : y;
+        if (a->izq[n] != NINGUNO) {
+            a->padre[a->izq[n]] = n;
+            a->padre[a->der[n]] = n;
+        } else if (a->simbolo[n] != NINGUNO) {
+            a->hoja[a->simbolo[n]] = n;
+        }
+    }
+    if (a->nyt == x) {
+        a->nyt = y;
+    } else if (a->nyt == y) {
+        a->nyt = x;
+    }
+}
+
+/*
+  Suma una aparicion de simbolo. Si es nuevo, NYT se divide en un NYT
+  nuevo y la hoja del simbolo. Despues, desde la hoja hasta la raiz, cada
+  nodo se cambia por el de mayor numero de su bloque (salvo su padre)
+  antes de aumentar su peso, asi se mantiene la propiedad de hermanos.
+*/
+static void actualizar(struct _Adaptativo* a, int simbolo) {
+    int q = a->hoja[simbolo];
+
+    if (q == NINGUNO) {
+        int viejo = a->nyt;
+        int nuevo = viejo - 2;
+        q = viejo - 1;
+
+        a->izq[viejo] = nuevo;
+        a->der[viejo] = q;
+        a->peso[q] = 0;
+        a->padre[q] = viejo;
+        a->izq[q] = NINGUNO;
+        a->der[q] = NINGUNO;
+        a->simbolo[q] = simbolo;
+        a->hoja[simbolo] = q;
+        a->peso[nuevo] = 0;
+        a->padre[nuevo] = viejo;
+        a->izq[nuevo] = NINGUNO;
+        a->der[nuevo] = NINGUNO;
+        a->simbolo[nuevo] = NINGUNO;
+        a->nyt = nuevo;
+    }
+
+    while (q != NINGUNO) {
+        int lider = q;
+        while (lider + 1 < ADAPTATIVO_NODOS && a->peso[lider + 1] == a->peso[q]) {
+            lider++;
+        }
+        /* El padre solo puede estar en el bloque si el hermano es NYT */
+        if (lider == a->padre[q]) {
+            lider--;
+        }
+        if (lider != q) {
+            intercambiar(a, q, lider);
+            q = lider;
+        }
+        a->peso[q]++;
+        q = a->padre[q];
+    }
+}
+
+/* Escribe el camino desde la raiz hasta el nodo n: 0 a la izquierda y 1
+   a la derecha */
+static void escribir_camino(struct _Adaptativo* a, BitStream out, int n) {
+    unsigned char camino[ADAPTATIVO_NODOS];
+    int largo = 0;
+
+    while (a->padre[n] != NINGUNO) {
+        camino[largo++] = a->der[a->padre[n]] == n;
+        n = a->padre[n];
+    }
+    while (largo > 0) {
+        unsigned long bits = 0;
+        int cantidad = 0;
+        while (largo > 0 && cantidad < 32) {
+            bits = (bits << 1) | camino[--largo];
+            cantidad++;
+        }
+        PutBits(out, bits, cantidad);
+    }
+}
+
+void adaptativo_codificar(Adaptativo arbol, BitStream out, int simbolo) {
+    struct _Adaptativo* a = (struct _Adaptativo*) arbol;
+
+    if (a->hoja[simbolo] != NINGUNO) {
+        escribir_camino(a, out, a->hoja[simbolo]);
+    } else {
+        escribir_camino(a, out, a->nyt);
+        PutBits(out, (unsigned long) simbolo, SIMBOLO_BITS);
+    }
+    actualizar(a, simbolo);
+}
+
+int adaptativo_decodificar(Adaptativo arbol, BitStream in) {
+    struct _Adaptativo* a = (struct _Adaptativo*) arbol;
+    int n = ADAPTATIVO_NODOS - 1;
+    int simbolo;
+
+    /* Bajar desde la raiz de a varios bits por vez */
+    while (a->izq[n] != NINGUNO) {
+        uint64_t ventana;
+        int disponibles = VentanaBits(in, &ventana);
+        int usados = 0;
+
+        if (disponibles == 0) {
+            return -1;
+        }
+        while (usados < disponibles && a->izq[n] != NINGUNO) {
+            n = (ventana >> 63) ? a->der[n] : a->izq[n];
+            ventana <<= 1;
+            usados++;
+        }
+        ConsumeBits(in, usados);
+    }
+
+    if (n == a->nyt) {
+        /* De a lo que haya en la ventana, que leyendo a medida que llegan
+           los datos puede tener menos de SIMBOLO_BITS */
+        int faltan = SIMBOLO_BITS;
+        simbolo = 0;
+        while (faltan > 0) {
+            uint64_t ventana;
+            int disponibles = VentanaBits(in, &ventana);
+            int usados = disponibles < faltan ? disponibles : faltan;
+
+            if (disponibles == 0) {
+                return -1;
+            }
+            simbolo = (simbolo << usados) | (int) (ventana >> (64 - usados));
+            ConsumeBits(in, usados);
+            faltan -= usados;
+        }
+        if (simbolo > ADAPTATIVO_FIN || a->hoja[simbolo] != NINGUNO) {
+            return -1;
+        }
+    } else {
+        simbolo = a->simbolo[n];
+    }
+    actualizar(a, simbolo);
+    return simbolo;
+}
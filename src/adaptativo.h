@@ -0,0 +1,41 @@
+/* Estas lineas hacen que este archivo se incluya solamente una vez por modulo */
+#ifndef DEFINE_ADAPTATIVO_H
+#define DEFINE_ADAPTATIVO_H
+
+#include "bitstream.h"
+
+/* Simbolos que se pueden codificar: los 256 bytes y ADAPTATIVO_FIN */
+#define ADAPTATIVO_SIMBOLOS 257
+
+/* Simbolo que marca el final de los datos */
+#define ADAPTATIVO_FIN 256
+
+/* Tipo opaco Adaptativo - un arbol de Huffman adaptativo (FGK) */
+typedef void* Adaptativo;
+
+/* Crea un arbol que solo tiene la hoja NYT ("todavia no visto").
+
+   El codificador y el decodificador empiezan con el mismo arbol y lo
+   actualizan igual despues de cada simbolo, asi que no hace falta
+   escribir ninguna tabla. Un simbolo nuevo se escribe como el codigo de
+   NYT seguido del simbolo en 9 bits.
+
+   Retorna NULL si falla.
+*/
+Adaptativo adaptativo_crear(void);
+
+/* Escribe en out el codigo de simbolo (0..ADAPTATIVO_FIN) y actualiza el
+   arbol. */
+void adaptativo_codificar(Adaptativo a, BitStream out, int simbolo);
+
+/* Lee de in un simbolo y actualiza el arbol igual que
+   adaptativo_codificar().
+
+   Retorna el simbolo, o -1 si se terminan los bits o el simbolo no es
+   valido. */
+int adaptativo_decodificar(Adaptativo a, BitStream in);
+
+/* Libera el arbol. */
+void adaptativo_destruir(Adaptativo a);
+
+#endif
@@ -1,157 +1,342 @@
-/** Nota: mi cabecera debe ir antes que nada */
-#include "arbol.h"
-
-#include <stdlib.h>
-#include <stdio.h>
-#include "confirm.h"
-
-#pragma warning(disable : 6011)
-
-/* Implementacion de cortesa ;P */
-
-/* Definicion interna para esta impelementacion */
-typedef struct _NodoArbol {
-  void* valor;
-  struct _NodoArbol* izq;
-  struct _NodoArbol* der;
-} * _Arbol;
-
-Arbol arbol_crear(void* valor) {
-    _Arbol nuevo = (_Arbol) malloc(sizeof(struct _NodoArbol));
-    nuevo->valor = valor;
-    nuevo->izq = NULL;
-    nuevo->der = NULL;
-    return (Arbol) nuevo;
-}
-
-/* Static en C (en este contexto) significa que solamente existe dentro de este archivo,
-   es decir, es privado
- */
-static void _destruir(Arbol raiz, void* ignorado) {
-    free(raiz);
-}
-
-void arbol_destruir(Arbol raiz) {
-    arbol_postorden(raiz, _destruir, 0);
-}
-
-void arbol_agregar(Arbol raiz, void* valor, int (*comparador)(void*,void*)) {
-    _Arbol T = (_Arbol) raiz;
-
-    CONFIRM_RETURN(T);
-
-    if (comparador(valor, T->valor) < 0) {
-        if (T->izq) {
-                arbol_agregar(T->izq, valor, comparador);
-        } else {
-                T->izq = arbol_crear(valor);
-                CONFIRM_RETURN(T->izq);
-        }
-    } else {
-        if (T->der) {
-                arbol_agregar(T->der, valor, comparador);
-        } else {
-                T->der = arbol_crear(valor);
-                CONFIRM_RETURN(T->der);
-        }
-    }
-}
-   
-   
-/* Nota: para llamar la funcion visitar solamente tienes que poner:
-
-    visitar(nodo);
-    
-   Donde nodo es el nodo que quieres visitar.. Facil??
-   
-*/
-void arbol_postorden(Arbol raiz, void (*visitar) (Arbol, void*), void* dato) {
-
-    _Arbol T = (_Arbol) raiz;
-    if (T) {
-        arbol_postorden(T->izq, visitar, dato);
-        arbol_postorden(T->der, visitar, dato);
-        visitar(T, dato);
-    }
-
-}
-
-void arbol_preorden(Arbol raiz, void (*visitar) (Arbol, void*), void* dato) {
-
-    _Arbol T = (_Arbol) raiz;
-    if (T) {
-        visitar(T, dato);
-        arbol_preorden(T->izq, visitar, dato);
-        arbol_preorden(T->der, visitar, dato);
-    }
-
-}
-
-void arbol_enorden(Arbol raiz, void (*visitar) (Arbol, void*), void* dato) {
-
-    _Arbol T = (_Arbol) raiz;
-    if (T) {
-        arbol_enorden(T->izq, visitar, dato);
-        visitar(T, dato);
-        arbol_enorden(T->der, visitar, dato);
-    }
-
-}
-
-
-static void _imprimir(Arbol raiz, int profundidad, void (*imprimir)(Arbol)) {
-
-    _Arbol T = (_Arbol) raiz;
-    if (T) {
-        
-        /* Imprimir el nodo */
-        int i = 0;
-        for (i = 0; i < profundidad; i++) {
-           printf("\t");
-        }
-        imprimir(T);
-        printf("\n");
-        
-        _imprimir(T->izq, profundidad+1, imprimir);
-        _imprimir(T->der, profundidad+1, imprimir);
-    }
-
-}
-
-void arbol_imprimir(Arbol T, void (*imprimir)(Arbol)) {
-
-    /* Delega su trabajo sucio a _imprimir() */
-    _imprimir(T, 0, imprimir);
-
-}
-
-
-
-void* arbol_valor(Arbol T) {
-    CONFIRM_NOTNULL(T, NULL);
-    return ((_Arbol)T)->valor;
-}
-
-Arbol arbol_izq(Arbol T) {
-    CONFIRM_NOTNULL(T, NULL);
-    return ((_Arbol)T)->izq;
-}
-
-Arbol arbol_der(Arbol T) {
-    CONFIRM_NOTNULL(T, NULL);
-    return ((_Arbol)T)->der;
-}
-
-void arbol_agregarIzq(Arbol nodo, Arbol izq) {
-    _Arbol T = (_Arbol) nodo;
-    CONFIRM_RETURN(T);
-    T->izq = izq;
-}
-
-
-void arbol_agregarDer(Arbol nodo, Arbol der) {
-    _Arbol T = (_Arbol) nodo;
-    CONFIRM_RETURN(T);
-    T->der= der;
-}
-
+/** Nota: mi cabecera debe ir antes que nada */
+#include "arbol.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "confirm.h"
+
+#pragma warning(disable : 6011)
+
+/* Implementacion de cortesa ;P */
+
+/* Definicion interna para esta impelementacion */
+typedef struct _NodoArbol {
+  void* valor;
+  struct _NodoArbol* izq;
+  struct _NodoArbol* der;
+} * _Arbol;
+
+/* Bloque de memoria de una arena, los datos van despues de la cabecera */
+typedef struct _BloqueArena {
+  struct _BloqueArena* sig;
+  size_t usado;
+  size_t tamano;
+} BloqueArena;
+
+/* Arena: lista de bloques, el que se esta llenando es el primero */
+typedef struct _Arena {
+  BloqueArena* bloques;
+  size_t tam_bloque;
+} * _ArbolArena;
+
+/* Todo lo que se saca de una arena queda alineado a esto */
+typedef union _Alineacion {
+  void* p;
+  double d;
+  long l;
+} Alineacion;
+
+#define ALINEAR(n) (((n) + sizeof(Alineacion) - 1) / sizeof(Alineacion) * sizeof(Alineacion))
+#define DATOS(b) ((char*) (b) + ALINEAR(sizeof(BloqueArena)))
+
+/* Alcanza para un arbol de Huffman de 256 hojas (511 nodos) y sus valores */
+#define ARENA_BLOQUE_DEFECTO (511 * (ALINEAR(sizeof(struct _NodoArbol)) + 2 * sizeof(Alineacion)))
+
+Arbol arbol_crear(void* valor) {
+    _Arbol nuevo = (_Arbol) malloc(sizeof(struct _NodoArbol));
+    nuevo->valor = valor;
+    nuevo->izq = NULL;
+    nuevo->der = NULL;
+    return (Arbol) nuevo;
+}
+
+/* Static en C (en este contexto) significa que solamente existe dentro de este archivo,
+   es decir, es privado
+ */
+static void _destruir(Arbol raiz, void* ignorado) {
+    free(raiz);
+}
+
+void arbol_destruir(Arbol raiz) {
+    arbol_postorden(raiz, _destruir, 0);
+}
+
+ArbolArena arbol_arena_crear(size_t tam_bloque) {
+    _ArbolArena arena = (_ArbolArena) malloc(sizeof(struct _Arena));
+    CONFIRM_NOTNULL(arena, NULL);
+    arena->bloques = NULL;
+    arena->tam_bloque = tam_bloque > 0 ? ALINEAR(tam_bloque) : ARENA_BLOQUE_DEFECTO;
+    return (ArbolArena) arena;
+}
+
+void* arbol_arena_reservar(ArbolArena a, size_t tamano) {
+    _ArbolArena arena = (_ArbolArena) a;
+    BloqueArena* bloque;
+    void* p;
+
+    CONFIRM_NOTNULL(arena, NULL);
+    tamano = ALINEAR(tamano);
+    bloque = arena->bloques;
+    if (!bloque || bloque->usado + tamano > bloque->tamano) {
+        /* No entra en el bloque actual: se pide uno nuevo */
+        size_t capacidad = tamano > arena->tam_bloque ? tamano : arena->tam_bloque;
+        bloque = (BloqueArena*) malloc(ALINEAR(sizeof(BloqueArena)) + capacidad);
+        CONFIRM_NOTNULL(bloque, NULL);
+        bloque->usado = 0;
+        bloque->tamano = capacidad;
+        bloque->sig = arena->bloques;
+        arena->bloques = bloque;
+    }
+    p = DATOS(bloque) + bloque->usado;
+    bloque->usado += tamano;
+    return p;
+}
+
+Arbol arbol_crear_en(ArbolArena arena, void* valor) {
+    _Arbol nuevo = (_Arbol) arbol_arena_reservar(arena, sizeof(struct _NodoArbol));
+    CONFIRM_NOTNULL(nuevo, NULL);
+    nuevo->valor = valor;
+    nuevo->izq = NULL;
+    nuevo->der = NULL;
+    return (Arbol) nuevo;
+}
+
+void arbol_arena_reiniciar(ArbolArena a) {
+    _ArbolArena arena = (_ArbolArena) a;
+    CONFIRM_RETURN(arena);
+    /* Se queda con el ultimo bloque de la lista, que es el primero que se pidio */
+    while (arena->bloques && arena->bloques->sig) {
+        BloqueArena* sig = arena->bloques->sig;
+        free(arena->bloques);
+        arena->bloques = sig;
+    }
+    if (arena->bloques) {
+        arena->bloques->usado = 0;
+    }
+}
+
+void arbol_arena_liberar(ArbolArena a) {
+    _ArbolArena arena = (_ArbolArena) a;
+    CONFIRM_RETURN(arena);
+    while (arena->bloques) {
+        BloqueArena* sig = arena->bloques->sig;
+        free(arena->bloques);
+        arena->bloques = sig;
+    }
+    free(arena);
+}
+
+void arbol_agregar(Arbol raiz, void* valor, int (*comparador)(void*,void*)) {
+    _Arbol T = (_Arbol) raiz;
+
+    CONFIRM_RETURN(T);
+
+    /* Baja hasta el lugar libre sin recursion */
+    for (;;) {
+        if (comparador(valor, T->valor) < 0) {
+            if (T->izq) {
+                    T = T->izq;
+            } else {
+                    T->izq = arbol_crear(valor);
+                    CONFIRM_RETURN(T->izq);
+                    return;
+            }
+        } else {
+            if (T->der) {
+                    T = T->der;
+            } else {
+                    T->der = arbol_crear(valor);
+                    CONFIRM_RETURN(T->der);
+                    return;
+            }
+        }
+    }
+}
+   
+   
+/* Los recorridos no son recursivos: usan una pila explicita en memoria
+   dinamica, asi un arbol muy profundo no puede desbordar la pila del
+   programa. Cada marco de la pila recuerda por que hijo va su nodo. */
+typedef struct _Marco {
+  _Arbol nodo;
+  int estado;   /* 0: falta el izquierdo, 1: falta el derecho, 2: terminado */
+} Marco;
+
+void arbol_recorrer(Arbol raiz, int orden,
+                    void (*visitar) (Arbol, int, const char*, void*), void* dato) {
+    int cap = 64;
+    int tope;
+    Marco* pila;
+    char* camino;
+
+    if (!raiz) {
+        return;
+    }
+    pila = (Marco*) malloc(cap * sizeof(Marco));
+    camino = (char*) malloc(cap + 1);
+    CONFIRM_GOTO(pila && camino, fin);
+
+    pila[0].nodo = (_Arbol) raiz;
+    pila[0].estado = 0;
+    tope = 1;
+    while (tope > 0) {
+        Marco* m = &pila[tope - 1];
+        _Arbol T = m->nodo;
+        int profundidad = tope - 1;
+        _Arbol hijo;
+        char bit;
+
+        /* camino[0..profundidad-1] es el camino desde la raiz hasta T */
+        camino[profundidad] = '\0';
+        if (m->estado == 0) {
+            m->estado = 1;
+            if (orden == ARBOL_PREORDEN) {
+                visitar(T, profundidad, camino, dato);
+            }
+            hijo = T->izq;
+            bit = '0';
+        } else if (m->estado == 1) {
+            m->estado = 2;
+            if (orden == ARBOL_ENORDEN) {
+                visitar(T, profundidad, camino, dato);
+            }
+            hijo = T->der;
+            bit = '1';
+        } else {
+            /* Despues de visitar en postorden T ya no se toca (puede haber sido liberado) */
+            tope--;
+            if (orden == ARBOL_POSTORDEN) {
+                visitar(T, profundidad, camino, dato);
+            }
+            continue;
+        }
+
+        if (hijo) {
+            if (tope == cap) {
+                Marco* p;
+                char* c;
+                cap *= 2;
+                p = (Marco*) realloc(pila, cap * sizeof(Marco));
+                CONFIRM_GOTO(p, fin);
+                pila = p;
+                c = (char*) realloc(camino, cap + 1);
+                CONFIRM_GOTO(c, fin);
+                camino = c;
+            }
+            camino[profundidad] = bit;
+            pila[tope].nodo = hijo;
+            pila[tope].estado = 0;
+            tope++;
+        }
+    }
+
+fin:
+    free(pila);
+    free(camino);
+}
+
+/* Adaptador para los recorridos cuya funcion de visita no usa el camino */
+typedef struct _VisitaSimple {
+  void (*visitar) (Arbol, void*);
+  void* dato;
+} VisitaSimple;
+
+static void _visita_simple(Arbol T, int profundidad, const char* camino, void* dato) {
+    VisitaSimple* v = (VisitaSimple*) dato;
+    (void) profundidad;
+    (void) camino;
+    v->visitar(T, v->dato);
+}
+
+static void _recorrer_simple(Arbol raiz, int orden, void (*visitar) (Arbol, void*), void* dato) {
+    VisitaSimple v;
+    v.visitar = visitar;
+    v.dato = dato;
+    arbol_recorrer(raiz, orden, _visita_simple, &v);
+}
+
+/* Nota: para llamar la funcion visitar solamente tienes que poner:
+
+    visitar(nodo);
+    
+   Donde nodo es el nodo que quieres visitar.. Facil??
+   
+*/
+void arbol_postorden(Arbol raiz, void (*visitar) (Arbol, void*), void* dato) {
+
+    _recorrer_simple(raiz, ARBOL_POSTORDEN, visitar, dato);
+
+}
+
+void arbol_preorden(Arbol raiz, void (*visitar) (Arbol, void*), void* dato) {
+
+    _recorrer_simple(raiz, ARBOL_PREORDEN, visitar, dato);
+
+}
+
+void arbol_enorden(Arbol raiz, void (*visitar) (Arbol, void*), void* dato) {
+
+    _recorrer_simple(raiz, ARBOL_ENORDEN, visitar, dato);
+
+}
+
+
+/* Funcion de impresion que usa arbol_imprimir, pasada como dato del recorrido */
+typedef struct _Impresion {
+  void (*imprimir)(Arbol);
+} Impresion;
+
+static void _imprimir(Arbol T, int profundidad, const char* camino, void* dato) {
+
+    Impresion* imp = (Impresion*) dato;
+        
+    /* Imprimir el nodo */
+    int i = 0;
+    (void) camino;
+    for (i = 0; i < profundidad; i++) {
+       printf("\t");
+    }
+    imp->imprimir(T);
+    printf("\n");
+
+}
+
+void arbol_imprimir(Arbol T, void (*imprimir)(Arbol)) {
+
+    /* Delega su trabajo sucio a _imprimir() */
+    Impresion imp;
+    imp.imprimir = imprimir;
+    arbol_recorrer(T, ARBOL_PREORDEN, _imprimir, &imp);
+
+}
+
+
+
+void* arbol_valor(Arbol T) {
+    CONFIRM_NOTNULL(T, NULL);
+    return ((_Arbol)T)->valor;
+}
+
+Arbol arbol_izq(Arbol T) {
+    CONFIRM_NOTNULL(T, NULL);
+    return ((_Arbol)T)->izq;
+}
+
+Arbol arbol_der(Arbol T) {
+    CONFIRM_NOTNULL(T, NULL);
+    return ((_Arbol)T)->der;
+}
+
+void arbol_agregarIzq(Arbol nodo, Arbol izq) {
+    _Arbol T = (_Arbol) nodo;
+    CONFIRM_RETURN(T);
+    T->izq = izq;
+}
+
+
+void arbol_agregarDer(Arbol nodo, Arbol der) {
+    _Arbol T = (_Arbol) nodo;
+    CONFIRM_RETURN(T);
+    T->der= der;
+}
+
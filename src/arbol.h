@@ -1,133 +1,209 @@
-/* Estas lineas hacen que este archivo se incluya solamente una vez por modulo
-   al compilar (esto evita que archivo A incluya a archivo B que incluye a 
-   archivo A que incluye archivo B.... ) */
-#ifndef DEFINE_ARBOL_H
-#define DEFINE_ARBOL_H
-
-/* Tipo opaco Arbol - no se revela su tipo verdadero en la interfaz */
-typedef void* Arbol;
-
-/* Este metodo es para crear un Arbol.
-   Recibe un valor para el primer nodo del arbol.
-   
-   Nota: este metodo tambien puede ser utilizado para crear nuevos nodos,
-   ya que un nodo no es mas que un Arbol de un solo elemento.
-   
-   Retorna NULL si falla.
-*/
-Arbol arbol_crear(void* valor);
-
-/* Este metodo es para destruir un Arbol (y todos sus sub-arboles).
-
-   Despues de llamar esto no utilice el arbol.
-*/
-void arbol_destruir(Arbol T);
-
-/* Agrega un elemento al arbol.
-
-  Tiene que especificar un comparador. El comparador permite al 
-  algoritmo de agregado comparar el nuevo valor con los valores
-  de los nodos para determinar su posicion en el arbol.
-  
-  Si fueramos a agregar ints al arbol su comparador podria ser:
-  
-     int comparadorInt(void* valor1, void* valor2) {
-          int a = (int) valor1;
-          int b = (int) valor2;
-          if (a < b) return -1;
-          else if (a > b) return 1;
-          else return 0;
-     }   
-
-   O su version simplificada (pero equivalente):
-
-     int comparadorInt(void* valor1, void* valor2) {
-          return (int) (valor1 - valor2);
-     }
-
-   Para llamarlo hariamos lo siguiente:
-   
-      Arbol T = arbol_crear((void*) 4);
-      arbol_agregar(T, (void*) 2, comparadorInt);
-      arbol_agregar(T, (void*) 6, comparadorInt);
-      
-*/
-void arbol_agregar(Arbol T, void* valor, int (*comparador)(void*,void*));
-
-
-/* Agrega un subarbol izquierdo al nodo dado.
-   (Nota: esto no destruye el subarbol que estaba alli)
-*/
-void arbol_agregarIzq(Arbol nodo, Arbol izq);
-
-
-/* Agrega un subarbol derecho al nodo dado.
-   (Nota: esto no destruye el subarbol que estaba alli)
-*/
-void arbol_agregarDer(Arbol nodo, Arbol der);
-   
-   
-/* Este metodo es para recorrer un arbol en post-orden.
-
-   Especifique el metodo de visita.
-   
-   Un metodo de visita ejemplar (para valores que son cadenas) es:
-   
-      void imprimir(Arbol T, void* ignorado) {
-            char* valor = arbol_valor(T);
-            if (NULL == valor)
-                  printf("NULL");
-            else 
-                  printf("%s", valor);
-      }
-      
-      
-   Despues si tengo un arbol T puedo imprimirlo todo asi:
-   
-      arbol_postorden(T, imprimir, 0);
-      
-   El ultimo campo es pasado como segundo parametro a la funcion de 
-   visita por si este lo necesita. Un ejemplo podria ser si convierto
-   el arbol en una lista podria hacerlo asi:
-   
-       arbol_postorden(T, convertir, lista);
-       
-   Donde convertir es la funcion que hace la conversion y lista la lista
-   que recibe los datos. 
-   
-      
-*/
-void arbol_postorden(Arbol T, void (*visitar) (Arbol, void*), void* dato);
-
-/* Preorden */
-void arbol_preorden(Arbol T, void (*visitar) (Arbol, void*), void* dato);
-
-/* Enorden */
-void arbol_enorden(Arbol T, void (*visitar) (Arbol, void*), void* dato);
-
-/* Obtiene el valor en la raiz del arbol especificado */
-void* arbol_valor(Arbol T);
-
-/* Obtiene el sub-arbol izquierdo */
-Arbol arbol_izq(Arbol T);
-
-/* Obtiene el sub-arbol derecho */
-Arbol arbol_der(Arbol T);
-
-/* Esta funcion imprime el arbol de manera linda para 
-   depuracion. 
-   
-   Recibe un metodo imprimir() para indicar como 
-   debe imprimir los nodos. Un ejemplo puede ser:
-   
-      static int mi_imprimir(Arbol nodo) {
-            Datos d = (Datos) arbol_valor(nodo);
-            printf("%d", d->valor);
-      }
-   Como lo implementas depende de los tipos de 
-   datos que contenga el arbol.
-*/
-void arbol_imprimir(Arbol T, void (*imprimir)(Arbol));
-
-
-#endif /* DEFINE_ARBOL_H */
+/* Estas lineas hacen que este archivo se incluya solamente una vez por modulo
+   al compilar (esto evita que archivo A incluya a archivo B que incluye a 
+   archivo A que incluye archivo B.... ) */
+#ifndef DEFINE_ARBOL_H
+#define DEFINE_ARBOL_H
+
+#include <stddef.h>
+
+/* Tipo opaco Arbol - no se revela su tipo verdadero en la interfaz */
+typedef void* Arbol;
+
+/* Tipo opaco ArbolArena - memoria de donde se sacan nodos (y sus valores)
+   que se liberan todos juntos */
+typedef void* ArbolArena;
+
+/* Este metodo es para crear un Arbol.
+   Recibe un valor para el primer nodo del arbol.
+   
+   Nota: este metodo tambien puede ser utilizado para crear nuevos nodos,
+   ya que un nodo no es mas que un Arbol de un solo elemento.
+   
+   Retorna NULL si falla.
+*/
+Arbol arbol_crear(void* valor);
+
+/* Este metodo es para destruir un Arbol (y todos sus sub-arboles).
+
+   Despues de llamar esto no utilice el arbol.
+*/
+void arbol_destruir(Arbol T);
+
+/* Crea una arena para nodos de Arbol.
+
+   Los nodos se van sacando de bloques de tam_bloque bytes (0 para el
+   tamano por defecto, suficiente para un arbol de Huffman completo de
+   511 nodos con sus valores), uno al lado del otro, asi que crear un
+   nodo no llama a malloc() y destruir el arbol entero es un solo free()
+   por bloque.
+
+   Retorna NULL si falla.
+*/
+ArbolArena arbol_arena_crear(size_t tam_bloque);
+
+/* Igual que arbol_crear() pero el nodo se saca de la arena.
+
+   Estos nodos NO se destruyen con arbol_destruir(), se liberan todos
+   juntos con arbol_arena_liberar() o arbol_arena_reiniciar().
+   
+   Retorna NULL si falla.
+*/
+Arbol arbol_crear_en(ArbolArena arena, void* valor);
+
+/* Reserva tamano bytes de la arena, por ejemplo para el valor de un nodo,
+   asi el nodo y su valor quedan juntos en memoria:
+
+      keyvaluepair* kv = arbol_arena_reservar(arena, sizeof(keyvaluepair));
+      Arbol nodo = arbol_crear_en(arena, kv);
+
+   La memoria se libera junto con la arena.
+
+   Retorna NULL si falla.
+*/
+void* arbol_arena_reservar(ArbolArena arena, size_t tamano);
+
+/* Descarta todos los nodos y valores de la arena pero se queda con su
+   primer bloque, para armar otro arbol sin volver a pedir memoria.
+*/
+void arbol_arena_reiniciar(ArbolArena arena);
+
+/* Libera la arena con todos sus nodos y valores.
+
+   Despues de llamar esto no utilice la arena ni sus arboles.
+*/
+void arbol_arena_liberar(ArbolArena arena);
+
+/* Agrega un elemento al arbol.
+
+  Tiene que especificar un comparador. El comparador permite al 
+  algoritmo de agregado comparar el nuevo valor con los valores
+  de los nodos para determinar su posicion en el arbol.
+  
+  Si fueramos a agregar ints al arbol su comparador podria ser:
+  
+     int comparadorInt(void* valor1, void* valor2) {
+          int a = (int) valor1;
+          int b = (int) valor2;
+          if (a < b) return -1;
+          else if (a > b) return 1;
+          else return 0;
+     }   
+
+   O su version simplificada (pero equivalente):
+
+     int comparadorInt(void* valor1, void* valor2) {
+          return (int) (valor1 - valor2);
+     }
+
+   Para llamarlo hariamos lo siguiente:
+   
+      Arbol T = arbol_crear((void*) 4);
+      arbol_agregar(T, (void*) 2, comparadorInt);
+      arbol_agregar(T, (void*) 6, comparadorInt);
+      
+*/
+void arbol_agregar(Arbol T, void* valor, int (*comparador)(void*,void*));
+
+
+/* Agrega un subarbol izquierdo al nodo dado.
+   (Nota: esto no destruye el subarbol que estaba alli)
+*/
+void arbol_agregarIzq(Arbol nodo, Arbol izq);
+
+
+/* Agrega un subarbol derecho al nodo dado.
+   (Nota: esto no destruye el subarbol que estaba alli)
+*/
+void arbol_agregarDer(Arbol nodo, Arbol der);
+   
+   
+/* Este metodo es para recorrer un arbol en post-orden.
+
+   Especifique el metodo de visita.
+   
+   Un metodo de visita ejemplar (para valores que son cadenas) es:
+   
+      void imprimir(Arbol T, void* ignorado) {
+            char* valor = arbol_valor(T);
+            if (NULL == valor)
+                  printf("NULL");
+            else 
+                  printf("%s", valor);
+      }
+      
+      
+   Despues si tengo un arbol T puedo imprimirlo todo asi:
+   
+      arbol_postorden(T, imprimir, 0);
+      
+   El ultimo campo es pasado como segundo parametro a la funcion de 
+   visita por si este lo necesita. Un ejemplo podria ser si convierto
+   el arbol en una lista podria hacerlo asi:
+   
+       arbol_postorden(T, convertir, lista);
+       
+   Donde convertir es la funcion que hace la conversion y lista la lista
+   que recibe los datos. 
+   
+      
+*/
+void arbol_postorden(Arbol T, void (*visitar) (Arbol, void*), void* dato);
+
+/* Preorden */
+void arbol_preorden(Arbol T, void (*visitar) (Arbol, void*), void* dato);
+
+/* Enorden */
+void arbol_enorden(Arbol T, void (*visitar) (Arbol, void*), void* dato);
+
+/* Ordenes para arbol_recorrer() */
+#define ARBOL_PREORDEN 0
+#define ARBOL_ENORDEN 1
+#define ARBOL_POSTORDEN 2
+
+/* Recorre el arbol en el orden dado (ARBOL_PREORDEN, ARBOL_ENORDEN o
+   ARBOL_POSTORDEN), pasandole ademas a la funcion de visita la
+   profundidad del nodo (0 para la raiz) y el camino desde la raiz hasta
+   el: una cadena de profundidad caracteres, '0' por cada paso a la
+   izquierda y '1' por cada paso a la derecha. En un arbol de Huffman
+   el camino de una hoja es su codigo:
+
+      void visitar(Arbol T, int profundidad, const char* camino, void* dato) {
+            if (NULL == arbol_izq(T) && NULL == arbol_der(T))
+                  printf("%s\n", camino);
+      }
+
+   La cadena solo vale durante la llamada, copiela si la necesita despues.
+
+   Ninguno de los recorridos es recursivo: usan una pila propia, asi que
+   un arbol muy profundo no desborda la pila del programa.
+*/
+void arbol_recorrer(Arbol T, int orden,
+                    void (*visitar) (Arbol T, int profundidad, const char* camino, void* dato),
+                    void* dato);
+
+/* Obtiene el valor en la raiz del arbol especificado */
+void* arbol_valor(Arbol T);
+
+/* Obtiene el sub-arbol izquierdo */
+Arbol arbol_izq(Arbol T);
+
+/* Obtiene el sub-arbol derecho */
+Arbol arbol_der(Arbol T);
+
+/* Esta funcion imprime el arbol de manera linda para 
+   depuracion. 
+   
+   Recibe un metodo imprimir() para indicar como 
+   debe imprimir los nodos. Un ejemplo puede ser:
+   
+      static int mi_imprimir(Arbol nodo) {
+            Datos d = (Datos) arbol_valor(nodo);
+            printf("%d", d->valor);
+      }
+   Como lo implementas depende de los tipos de 
+   datos que contenga el arbol.
+*/
+void arbol_imprimir(Arbol T, void (*imprimir)(Arbol));
+
+
+#endif /* DEFINE_ARBOL_H */
@@ -1,135 +1,460 @@
-/* 
-  Origen de este archivo:
-  
-  University of Washington
-  CSE 326 --- Steve Burns, Spring 1994  
-  
-  Modificaciones:
-  - Amin Mansuri, 2003
-  - Andi Fukuchi, 2019
-*/
-
-#include <stdlib.h>
-#include <stdio.h>
-#include "bitstream.h"
-
-#define NDEPURAR
-
-#define MALLOC(type) (type *) malloc( sizeof( type))
-#pragma warning(disable : 4996)
-
-struct _BitStream {
-   int c1, c2, c3;
-   int type;
-   int position;
-   FILE *fp;
-};
-
-
-BitStream OpenBitStream( char *filename, char *type_str)
-{
-	struct _BitStream *bs = MALLOC( struct _BitStream);
-	#pragma warning(suppress:6011)
-	if ( !(bs->fp=fopen( filename, type_str))) {
-		perror( "OpenBitStream");
-		free( (void *) bs);
-		return 0;
-	}
-	if ( *type_str == 'w') {
-		bs->type = BITSTREAM_WRITE;
-		bs->c1 = 0;
-	} else {
-		bs->type = BITSTREAM_READ;
-		bs->c1 = getc( bs->fp);
-		bs->c2 = getc( bs->fp);
-		bs->c3 = getc( bs->fp);
-	}
-	bs->position = 0;
-	return bs;
-}
-
-int CloseBitStream(BitStream bitStream)
-{
-	int rt=0;
-	struct _BitStream *bs = (struct _BitStream*) bitStream;
-
-#ifdef DEPURAR
-    rt = fclose(bs->fp);
-#else 	
-	if ( bs->type & BITSTREAM_WRITE) {
-		if ( (bs->position & 0x7) > 0) {
-			putc( bs->c1, bs->fp);
-			putc( (bs->position & 0x7), bs->fp);
-		} else if ( bs->position == 0)
-		putc( 0, bs->fp);
-		else
-			putc( 8, bs->fp);
-	}
-	
-	if ( rt=fclose( bs->fp))
-		perror( "CloseBitStream");
-#endif	
-	return rt;
-	
-}
-
-int IsEmptyBitStream(BitStream bitStream)
-{
-	struct _BitStream *bs = (struct _BitStream*) bitStream;
-	return bs->c2 == EOF ||
-	bs->c3 == EOF && (bs->position & 0x7) >= bs->c2;
-}
-
-int GetBit(BitStream bitStream)
-{
-	struct _BitStream *bs = (struct _BitStream*) bitStream;
-	int value = (bs->c1 & (0x80 >> (bs->position & 0x7))) ? 1 : 0;
-	if ( ((++bs->position) & 0x7) == 0) {
-		bs->c1 = bs->c2;
-		bs->c2 = bs->c3;
-		bs->c3 = getc( bs->fp);
-	}
-	return value;
-}
-
-unsigned char GetByte(BitStream bitStream)
-{
-	unsigned int i;
-	unsigned char c = 0;
-	struct _BitStream *bs = (struct _BitStream*) bitStream;
-	for (i=0; i<8; i++)
-		if ( GetBit( bs))
-			c |= 0x80 >> i;
-	return c;
-}
-
-void PutBit(BitStream bitStream, int bit)
-{
-	struct _BitStream *bs = (struct _BitStream*) bitStream;
-#ifdef DEPURAR
-    putc(bit?'1':'0', bs->fp);
-#else
-	if ( bit)
-		bs->c1 |= (0x80 >> (bs->position & 0x7));
-	else
-		bs->c1 &= ~(0x80 >> (bs->position & 0x7));
-	
-	if ( ((++bs->position) & 0x7) == 0) {
-		putc( bs->c1, bs->fp);
-		bs->c1 = 0;
-	}
-#endif
-}
-
-void PutByte(BitStream bitStream, unsigned char c)
-{
-	int i;
-	struct _BitStream *bs = (struct _BitStream*) bitStream;
-
-#ifdef DEPURAR
-    putc(c, bs->fp);
-#else 
-	for( i=0; i<8; i++)
-		PutBit( bs, c & ( 0x80 >> i));
-#endif
-}
+/* 
+  Origen de este archivo:
+  
+  University of Washington
+  CSE 326 --- Steve Burns, Spring 1994  
+  
+  Modificaciones:
+  - Amin Mansuri, 2003
+  - Andi Fukuchi, 2019
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "bitstream.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+#define NDEPURAR
+
+#define MALLOC(type) (type *) malloc( sizeof( type))
+#pragma warning(disable : 4996)
+
+/* Tamano del buffer de bloque; en escritura se vuelca con fwrite cuando
+   se llena y en lectura se rellena con fread */
+#define BITSTREAM_BUFFER 65536
+
+struct _BitStream {
+   int type;
+   FILE *fp;
+   /* 1 si fp lo abrio OpenBitStream() y hay que cerrarlo */
+   int propio;
+   /* 1 si los bytes estan en memoria en vez de en fp */
+   int memoria;
+   /* 1 si no se pudo agrandar el buffer de un BitStream en memoria */
+   int error;
+   /* 1 si se lee a medida que llegan los datos (OpenBitStreamFlujo()),
+      y el archivo a vaciar antes de esperarlos */
+   int flujo;
+   FILE *vaciar;
+   /* Escritura: acumulador de 64 bits (los nacc bits menos significativos
+      son los pendientes) que se vuelca de a palabras de 32 bits en buf */
+   uint64_t acc;
+   int nacc;
+   int escrito;
+   /* Lectura: registro de 64 bits alineado a la izquierda con nreg bits
+      validos, que se rellena byte a byte desde buf[pos..nbuf) */
+   uint64_t reg;
+   int nreg;
+   int fin;
+   size_t pos;
+   unsigned char *buf;
+   size_t nbuf;
+   size_t capacidad;
+};
+
+/* Vuelca el buffer de salida al archivo. En memoria no hay donde
+   volcarlo, asi que se duplica su tamano */
+static void _volcar(struct _BitStream *bs)
+{
+	if ( bs->memoria) {
+		unsigned char *nuevo = (unsigned char *) realloc( bs->buf, bs->capacidad * 2);
+		if ( nuevo) {
+			bs->buf = nuevo;
+			bs->capacidad *= 2;
+		} else {
+			/* Se pierde lo escrito pero no se escribe fuera del buffer */
+			bs->error = 1;
+			bs->nbuf = 0;
+		}
+		return;
+	}
+	if ( bs->nbuf > 0) {
+		fwrite( bs->buf, 1, bs->nbuf, bs->fp);
+		bs->nbuf = 0;
+	}
+}
+
+/* Lee el siguiente bloque del archivo conservando los bytes que quedaban
+   sin usar al principio del buffer */
+static void _leer_bloque(struct _BitStream *bs)
+{
+	size_t quedan = bs->nbuf - bs->pos;
+	size_t leidos;
+
+	if ( quedan > 0 && bs->pos > 0)
+		memmove( bs->buf, bs->buf + bs->pos, quedan);
+	bs->pos = 0;
+	bs->nbuf = quedan;
+	if ( bs->flujo) {
+		long r;
+		if ( bs->vaciar)
+			fflush( bs->vaciar);
+		r = LeerDisponible( bs->fp, bs->buf + quedan, BITSTREAM_BUFFER - quedan);
+		leidos = r > 0 ? (size_t) r : 0;
+	} else
+		leidos = fread( bs->buf + quedan, 1, BITSTREAM_BUFFER - quedan, bs->fp);
+	if ( leidos == 0)
+		bs->fin = 1;
+	bs->nbuf += leidos;
+}
+
+/* Carga bytes en el registro de lectura hasta tener mas de 56 bits o
+   llegar al final del stream.
+
+   El ultimo byte del archivo no son datos, es la cantidad de bits validos
+   del byte anterior (ver CloseBitStream), por eso un byte solo se carga
+   si se sabe que le siguen al menos dos mas, o si ya se llego al final
+   del archivo y es el ultimo byte de datos.
+
+   En un flujo todos los bytes son datos y solo se espera a que lleguen
+   mas si hay menos de minimo bits; si no se carga lo que ya llego. */
+static void _rellenar(struct _BitStream *bs, int minimo)
+{
+	/* En memoria todos los bytes son datos */
+	if ( bs->memoria) {
+		while ( bs->nreg <= 56 && bs->pos < bs->nbuf) {
+			bs->reg |= (uint64_t) bs->buf[bs->pos++] << (56 - bs->nreg);
+			bs->nreg += 8;
+		}
+		return;
+	}
+	while ( bs->nreg <= 56) {
+		size_t quedan = bs->nbuf - bs->pos;
+		if ( quedan >= 3 || (bs->flujo && quedan > 0)) {
+			bs->reg |= (uint64_t) bs->buf[bs->pos++] << (56 - bs->nreg);
+			bs->nreg += 8;
+		} else if ( !bs->fin) {
+			if ( bs->flujo && bs->nreg >= minimo)
+				break;
+			_leer_bloque( bs);
+		} else {
+			if ( quedan == 2) {
+				int validos = bs->buf[bs->pos + 1];
+				if ( validos > 8)
+					validos = 8;
+				bs->reg |= (uint64_t) bs->buf[bs->pos] << (56 - bs->nreg);
+				bs->nreg += validos;
+			}
+			bs->pos = bs->nbuf;
+			break;
+		}
+	}
+}
+
+
+/* Crea un BitStream sin archivo ni buffer, con todo en cero */
+static struct _BitStream *_crear(int type)
+{
+	struct _BitStream *bs = MALLOC( struct _BitStream);
+	if ( !bs)
+		return 0;
+	bs->type = type;
+	bs->fp = 0;
+	bs->propio = 0;
+	bs->memoria = 0;
+	bs->error = 0;
+	bs->flujo = 0;
+	bs->vaciar = 0;
+	bs->acc = 0;
+	bs->nacc = 0;
+	bs->escrito = 0;
+	bs->reg = 0;
+	bs->nreg = 0;
+	bs->fin = 0;
+	bs->pos = 0;
+	bs->buf = 0;
+	bs->nbuf = 0;
+	bs->capacidad = 0;
+	return bs;
+}
+
+BitStream OpenBitStream( char *filename, char *type_str)
+{
+	FILE *fp;
+	struct _BitStream *bs;
+
+	if ( !(fp=fopen( filename, type_str))) {
+		perror( "OpenBitStream");
+		return 0;
+	}
+	bs = (struct _BitStream *) OpenBitStreamFile( fp, type_str);
+	if ( !bs) {
+		fclose( fp);
+		return 0;
+	}
+	bs->propio = 1;
+	return bs;
+}
+
+BitStream OpenBitStreamFile( FILE *fp, char *type_str)
+{
+	struct _BitStream *bs = _crear( *type_str == 'w' ? BITSTREAM_WRITE : BITSTREAM_READ);
+	if ( !bs)
+		return 0;
+	bs->fp = fp;
+	bs->buf = (unsigned char *) malloc( BITSTREAM_BUFFER);
+	if ( !bs->buf) {
+		free( (void *) bs);
+		return 0;
+	}
+	bs->capacidad = BITSTREAM_BUFFER;
+	if ( bs->type == BITSTREAM_READ)
+		_rellenar( bs, 64);
+	return bs;
+}
+
+BitStream OpenBitStreamFlujo( FILE *fp, FILE *vaciar)
+{
+	struct _BitStream *bs = _crear( BITSTREAM_READ);
+	if ( !bs)
+		return 0;
+	bs->fp = fp;
+	bs->flujo = 1;
+	bs->vaciar = vaciar;
+	bs->buf = (unsigned char *) malloc( BITSTREAM_BUFFER);
+	if ( !bs->buf) {
+		free( (void *) bs);
+		return 0;
+	}
+	bs->capacidad = BITSTREAM_BUFFER;
+	/* Sin leer nada todavia: se espera recien cuando se piden bits */
+	return bs;
+}
+
+BitStream OpenBitStreamMemory( const unsigned char *data, size_t n)
+{
+	struct _BitStream *bs = _crear( data ? BITSTREAM_READ : BITSTREAM_WRITE);
+	if ( !bs)
+		return 0;
+	bs->memoria = 1;
+	if ( data) {
+		/* El buffer es del que llama; CloseBitStream() no lo libera */
+		bs->buf = (unsigned char *) data;
+		bs->nbuf = n;
+		bs->capacidad = n;
+		bs->fin = 1;
+		_rellenar( bs, 64);
+	} else {
+		bs->capacidad = n > 16 ? n : 16;
+		bs->buf = (unsigned char *) malloc( bs->capacidad);
+		if ( !bs->buf) {
+			free( (void *) bs);
+			return 0;
+		}
+	}
+	return bs;
+}
+
+/* Completa el ultimo byte con ceros y pasa todo lo pendiente al buffer.
+   Retorna cuantos bits validos tiene el ultimo byte (0 si esta completo) */
+static int _completar(struct _BitStream *bs)
+{
+	int resto = bs->nacc & 0x7;
+	if ( resto > 0)
+		PutBits( bs, 0, 8 - resto);
+	while ( bs->nbuf + 9 > bs->capacidad && !bs->error)
+		_volcar( bs);
+	while ( bs->nacc > 0) {
+		bs->nacc -= 8;
+		bs->buf[bs->nbuf++] = (unsigned char) (bs->acc >> bs->nacc);
+	}
+	return resto;
+}
+
+unsigned char *CloseBitStreamMemory(BitStream bitStream, size_t *n)
+{
+	struct _BitStream *bs = (struct _BitStream*) bitStream;
+	unsigned char *buf;
+
+	_completar( bs);
+	buf = bs->buf;
+	*n = bs->nbuf;
+	if ( bs->error) {
+		free( buf);
+		buf = 0;
+		*n = 0;
+	}
+	free( bs);
+	return buf;
+}
+
+int CloseBitStream(BitStream bitStream)
+{
+	int rt=0;
+	struct _BitStream *bs = (struct _BitStream*) bitStream;
+
+	if ( !bs)
+		return 0;
+#ifdef DEPURAR
+    rt = fclose(bs->fp);
+#else 	
+	if ( bs->memoria) {
+		/* Un buffer de lectura es del que llamo a OpenBitStreamMemory() */
+		if ( bs->type & BITSTREAM_WRITE)
+			free( bs->buf);
+		free( bs);
+		return 0;
+	}
+	if ( bs->type & BITSTREAM_WRITE) {
+		/* Completa el ultimo byte con ceros y vuelca todo lo pendiente */
+		int resto = _completar( bs);
+		if ( resto > 0)
+			bs->buf[bs->nbuf++] = (unsigned char) resto;
+		else if ( !bs->escrito)
+			bs->buf[bs->nbuf++] = 0;
+		else
+			bs->buf[bs->nbuf++] = 8;
+		_volcar( bs);
+	}
+	
+	if ( bs->propio && (rt=fclose( bs->fp)))
+		perror( "CloseBitStream");
+	else if ( !bs->propio && (bs->type & BITSTREAM_WRITE))
+		rt = fflush( bs->fp);
+#endif	
+	free( bs->buf);
+	free( bs);
+	return rt;
+	
+}
+
+int FlushBitStream(BitStream bitStream)
+{
+	struct _BitStream *bs = (struct _BitStream*) bitStream;
+
+	if ( bs->memoria)
+		return 0;
+	while ( bs->nacc >= 8) {
+		if ( bs->nbuf + 1 > bs->capacidad)
+			_volcar( bs);
+		bs->nacc -= 8;
+		bs->buf[bs->nbuf++] = (unsigned char) (bs->acc >> bs->nacc);
+	}
+	_volcar( bs);
+	return fflush( bs->fp);
+}
+
+int IsEmptyBitStream(BitStream bitStream)
+{
+	struct _BitStream *bs = (struct _BitStream*) bitStream;
+	if ( bs->nreg == 0)
+		_rellenar( bs, 1);
+	return bs->nreg == 0;
+}
+
+int GetBit(BitStream bitStream)
+{
+	int value = (int) PeekBits( bitStream, 1);
+	ConsumeBits( bitStream, 1);
+	return value;
+}
+
+unsigned char GetByte(BitStream bitStream)
+{
+	unsigned char c = (unsigned char) PeekBits( bitStream, 8);
+	ConsumeBits( bitStream, 8);
+	return c;
+}
+
+unsigned long PeekBits(BitStream bitStream, int n)
+{
+	struct _BitStream *bs = (struct _BitStream*) bitStream;
+	if ( n <= 0)
+		return 0;
+	if ( bs->nreg < n)
+		_rellenar( bs, n);
+	return (unsigned long) (bs->reg >> (64 - n));
+}
+
+void ConsumeBits(BitStream bitStream, int n)
+{
+	struct _BitStream *bs = (struct _BitStream*) bitStream;
+	if ( n > bs->nreg)
+		n = bs->nreg;
+	/* n puede ser 64 solo si el registro esta lleno, y un desplazamiento
+	   de 64 no esta definido en C */
+	bs->reg = (n < 64) ? bs->reg << n : 0;
+	bs->nreg -= n;
+}
+
+int BitsDisponibles(BitStream bitStream)
+{
+	struct _BitStream *bs = (struct _BitStream*) bitStream;
+	if ( bs->nreg < 32)
+		_rellenar( bs, 32);
+	return bs->nreg;
+}
+
+int VentanaBits(BitStream bitStream, uint64_t* ventana)
+{
+	struct _BitStream *bs = (struct _BitStream*) bitStream;
+	if ( bs->nreg <= 56)
+		_rellenar( bs, 1);
+	*ventana = bs->reg;
+	return bs->nreg;
+}
+
+void PutBit(BitStream bitStream, int bit)
+{
+	struct _BitStream *bs = (struct _BitStream*) bitStream;
+#ifdef DEPURAR
+    putc(bit?'1':'0', bs->fp);
+#else
+	PutBits( bs, bit ? 1 : 0, 1);
+#endif
+}
+
+void PutByte(BitStream bitStream, unsigned char c)
+{
+	struct _BitStream *bs = (struct _BitStream*) bitStream;
+
+#ifdef DEPURAR
+    putc(c, bs->fp);
+#else 
+	PutBits( bs, c, 8);
+#endif
+}
+
+void PutBits(BitStream bitStream, unsigned long value, int nbits)
+{
+	struct _BitStream *bs = (struct _BitStream*) bitStream;
+
+	if ( nbits <= 0)
+		return;
+	bs->escrito = 1;
+	bs->acc = (bs->acc << nbits) | (value & (0xFFFFFFFFUL >> (32 - nbits)));
+	bs->nacc += nbits;
+	/* Palabra completa: se copian 4 bytes al buffer de salida */
+	if ( bs->nacc >= 32) {
+		uint32_t palabra;
+		bs->nacc -= 32;
+		palabra = (uint32_t) (bs->acc >> bs->nacc);
+		if ( bs->nbuf + 4 > bs->capacidad)
+			_volcar( bs);
+		bs->buf[bs->nbuf++] = (unsigned char) (palabra >> 24);
+		bs->buf[bs->nbuf++] = (unsigned char) (palabra >> 16);
+		bs->buf[bs->nbuf++] = (unsigned char) (palabra >> 8);
+		bs->buf[bs->nbuf++] = (unsigned char) palabra;
+	}
+}
+
+long LeerDisponible(FILE *fp, unsigned char *destino, size_t n)
+{
+	long leidos;
+#ifdef _WIN32
+	leidos = _read( _fileno( fp), destino, (unsigned int) n);
+#else
+	do {
+		leidos = (long) read( fileno( fp), destino, n);
+	} while ( leidos < 0 && errno == EINTR);
+#endif
+	return leidos;
+}
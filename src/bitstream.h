@@ -1,56 +1,144 @@
-/* 
-  Origen de este archivo:
-  
-  University of Washington
-  CSE 326 --- Steve Burns, Spring 1994  
-  
-  Modificaciones:
-  - Amin Mansuri, 2003
-*/
-
-#ifndef DEFINE_BITSTREAM_H
-#define DEFINE_BITSTREAM_H
-
-#include <stdio.h>
-
-#define BITSTREAM_READ 0x1
-#define BITSTREAM_WRITE 0x2
-
-typedef void* BitStream;
-
-/*
-  Abre un archivo para leer (BITSTREAM_READ) o escribir (BITSTREAM_WRITE)
-*/
-BitStream OpenBitStream( char *filename, char *type_str);
-
-/*
- Cierra el archivo 
-*/
-int CloseBitStream(BitStream bs);
-
-/*
-  Si esta vacio el BitStream
-*/
-int IsEmptyBitStream(BitStream bs);
-
-/*
-  Obtiene el bit
-*/
-int GetBit(BitStream bs);
-
-/* 
-  Escribe un bit
-*/
-void PutBit(BitStream bs, int bit);
-
-/* 
-  Obtiene un byte
-*/
-unsigned char GetByte(BitStream bs);
-
-/*
-  Escribe un byte
-*/
-void PutByte(BitStream bs, unsigned char c);
-
-#endif
+/* 
+  Origen de este archivo:
+  
+  University of Washington
+  CSE 326 --- Steve Burns, Spring 1994  
+  
+  Modificaciones:
+  - Amin Mansuri, 2003
+*/
+
+#ifndef DEFINE_BITSTREAM_H
+#define DEFINE_BITSTREAM_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define BITSTREAM_READ 0x1
+#define BITSTREAM_WRITE 0x2
+
+typedef void* BitStream;
+
+/*
+  Abre un archivo para leer (BITSTREAM_READ) o escribir (BITSTREAM_WRITE)
+*/
+BitStream OpenBitStream( char *filename, char *type_str);
+
+/*
+  Igual que OpenBitStream() pero sobre un archivo ya abierto, desde su
+  posicion actual. CloseBitStream() no lo cierra (solo vacia lo que
+  falta escribir).
+*/
+BitStream OpenBitStreamFile( FILE *fp, char *type_str);
+
+/*
+  Igual que OpenBitStreamFile() para leer, pero a medida que llegan los
+  datos (una tuberia, por ejemplo): toma de fp lo que ya llego con
+  LeerDisponible() y solo espera si faltan bits para lo que se pide.
+  Antes de esperar hace fflush(vaciar), si no es NULL, para que lo que
+  ya se escribio no quede retenido mientras tanto.
+  
+  Como en memoria, todos los bytes son datos (el ultimo no se aparta
+  como cantidad de bits validos, para no tener que esperar los dos que
+  le siguen): el que lee tiene que saber donde terminan. fp no tiene
+  que tener nada leido con stdio (se lee su descriptor).
+*/
+BitStream OpenBitStreamFlujo( FILE *fp, FILE *vaciar);
+
+/*
+  BitStream en memoria. Si data no es NULL lee los n bytes de data (todos
+  son datos, sin el byte final de OpenBitStream()); data tiene que
+  existir hasta CloseBitStream(). Si data es NULL escribe en un buffer que
+  empieza de n bytes y crece solo; se obtiene con CloseBitStreamMemory().
+*/
+BitStream OpenBitStreamMemory( const unsigned char *data, size_t n);
+
+/*
+ Cierra el archivo 
+*/
+int CloseBitStream(BitStream bs);
+
+/*
+  Escribe en el archivo de un BitStream de escritura los bytes completos
+  y hace fflush(); los bits de un byte incompleto siguen pendientes.
+  
+  Retorna 0 si no hay errores.
+*/
+int FlushBitStream(BitStream bs);
+
+/*
+  Cierra un BitStream de escritura en memoria completando el ultimo byte
+  con ceros. Retorna el buffer (que hay que liberar con free()) y deja en
+  *n su cantidad de bytes, o retorna NULL si no hubo memoria.
+*/
+unsigned char *CloseBitStreamMemory(BitStream bs, size_t *n);
+
+/*
+  Si esta vacio el BitStream
+*/
+int IsEmptyBitStream(BitStream bs);
+
+/*
+  Obtiene el bit
+*/
+int GetBit(BitStream bs);
+
+/* 
+  Escribe un bit
+*/
+void PutBit(BitStream bs, int bit);
+
+/* 
+  Obtiene un byte
+*/
+unsigned char GetByte(BitStream bs);
+
+/*
+  Escribe un byte
+*/
+void PutByte(BitStream bs, unsigned char c);
+
+/*
+  Devuelve los siguientes n bits (1 <= n <= 32) sin consumirlos, el primero
+  en el bit mas significativo. Pasado el final del stream se leen ceros.
+*/
+unsigned long PeekBits(BitStream bs, int n);
+
+/*
+  Descarta los siguientes n bits (n <= 64, sin pasar de los que devolvio
+  BitsDisponibles() o VentanaBits())
+*/
+void ConsumeBits(BitStream bs, int n);
+
+/*
+  Cantidad de bits que se pueden leer sin rellenar (al menos 32 si no se
+  llego al final del stream, 0 si esta vacio)
+*/
+int BitsDisponibles(BitStream bs);
+
+/*
+  Deja en *ventana los siguientes bits sin consumirlos, alineados al bit
+  mas significativo y con ceros despues de los validos. Retorna cuantos
+  son validos (mas de 56 si no se llego al final del stream; con
+  OpenBitStreamFlujo() al menos 1, los que ya llegaron).
+  
+  Sirve para leer varios codigos seguidos con un solo rellenado y
+  consumirlos todos juntos despues con ConsumeBits().
+*/
+int VentanaBits(BitStream bs, uint64_t* ventana);
+
+/*
+  Escribe los nbits menos significativos de value (0 <= nbits <= 32),
+  empezando por el mas significativo de ellos.
+*/
+void PutBits(BitStream bs, unsigned long value, int nbits);
+
+/*
+  Lee de fp hasta n bytes, sin stdio: retorna apenas llega algo, en vez
+  de esperar los n como fread().
+  
+  Retorna cuantos leyo, 0 al final del archivo o -1 si hay errores.
+*/
+long LeerDisponible(FILE *fp, unsigned char *destino, size_t n);
+
+#endif
@@ -0,0 +1,149 @@
+/** Nota: mi cabecera debe ir antes que nada */
+#include "histograma.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#define HISTOGRAMA_HILOS
+#endif
+
+/* Tramo minimo por hilo; con menos no vale la pena crear el hilo */
+#define HISTOGRAMA_TRAMO_MINIMO ((size_t) 4 << 20)
+
+/* Cantidad de sub-tablas que se usan a la vez */
+#define SUBTABLAS 4
+
+/* Bytes que se cuentan antes de pasar las sub-tablas de 32 bits a los
+   totales de 64, de modo que ningun contador llegue a 2^32 */
+#define TRAMO ((size_t) 1 << 30)
+
+/*
+  Contar en una sola tabla hace que una racha del mismo byte incremente
+  siempre el mismo contador, y cada incremento tiene que esperar a que
+  termine el anterior (lee lo que el otro acaba de escribir). Con cuatro
+  sub-tablas, bytes consecutivos van a contadores distintos y los
+  incrementos se pueden hacer en paralelo; al final se suman.
+*/
+void histograma_contar(const unsigned char* datos, size_t n, uint64_t frecuencias[HISTOGRAMA_SIMBOLOS]) {
+    uint32_t sub[SUBTABLAS][HISTOGRAMA_SIMBOLOS];
+
+    while (n > 0) {
+        size_t tramo = n < TRAMO ? n : TRAMO;
+        const unsigned char* p = datos;
+        const unsigned char* fin = datos + (tramo & ~(size_t) 7);
+        const unsigned char* ultimo = datos + tramo;
+        int i;
+
+        memset(sub, 0, sizeof(sub));
+
+        /* De a 8 bytes: dos palabras de 32 bits repartidas en las sub-tablas */
+        while (p < fin) {
+            uint32_t a = (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+            uint32_t b = (uint32_t) p[4] | ((uint32_t) p[5] << 8) | ((uint32_t) p[6] << 16) | ((uint32_t) p[7] << 24);
+            sub[0][a & 0xFF]++;
+            sub[1][(a >> 8) & 0xFF]++;
+            sub[2][(a >> 16) & 0xFF]++;
+            sub[3][a >> 24]++;
+            sub[0][b & 0xFF]++;
+            sub[1][(b >> 8) & 0xFF]++;
+            sub[2][(b >> 16) & 0xFF]++;
+            sub[3][b >> 24]++;
+            p += 8;
+        }
+        while (p < ultimo) {
+            sub[0][*p++]++;
+        }
+
+        for (i = 0; i < HISTOGRAMA_SIMBOLOS; i++) {
+            frecuencias[i] += (uint64_t) sub[0][i] + sub[1][i] + sub[2][i] + sub[3][i];
+        }
+
+        datos += tramo;
+        n -= tramo;
+    }
+}
+
+#ifdef HISTOGRAMA_HILOS
+
+/* Lo que necesita cada hilo: su tramo de los datos y su propia tabla */
+typedef struct _tarea_histograma {
+    const unsigned char* datos;
+    size_t n;
+    uint64_t frecuencias[HISTOGRAMA_SIMBOLOS];
+} tarea_histograma;
+
+/* Cuerpo de cada hilo */
+static void* contar_tramo(void* arg) {
+    tarea_histograma* t = (tarea_histograma*) arg;
+    histograma_contar(t->datos, t->n, t->frecuencias);
+    return NULL;
+}
+
+void histograma_contar_hilos(const unsigned char* datos, size_t n, int hilos,
+                             uint64_t frecuencias[HISTOGRAMA_SIMBOLOS]) {
+    tarea_histograma* tareas;
+    pthread_t* ids;
+    size_t tramo;
+    int creados = 0;
+    int i, j;
+
+    if ((size_t) hilos > n / HISTOGRAMA_TRAMO_MINIMO) {
+        hilos = (int) (n / HISTOGRAMA_TRAMO_MINIMO);
+    }
+    if (hilos <= 1) {
+        histograma_contar(datos, n, frecuencias);
+        return;
+    }
+
+    tareas = (tarea_histograma*) calloc(hilos, sizeof(tarea_histograma));
+    ids = (pthread_t*) malloc(hilos * sizeof(pthread_t));
+    if (!tareas || !ids) {
+        free(tareas);
+        free(ids);
+        histograma_contar(datos, n, frecuencias);
+        return;
+    }
+
+    tramo = n / hilos;
+    for (i = 0; i < hilos; i++) {
+        tareas[i].datos = datos + i * tramo;
+        tareas[i].n = (i == hilos - 1) ? n - i * tramo : tramo;
+    }
+
+    /* El hilo actual cuenta el primer tramo mientras los otros cuentan el resto */
+    for (i = 1; i < hilos; i++) {
+        if (pthread_create(&ids[i], NULL, contar_tramo, &tareas[i]) != 0) {
+            break;
+        }
+        creados = i;
+    }
+    contar_tramo(&tareas[0]);
+    /* Si no se pudo crear algun hilo, sus tramos se cuentan aca */
+    for (i = creados + 1; i < hilos; i++) {
+        contar_tramo(&tareas[i]);
+    }
+    for (i = 1; i <= creados; i++) {
+        pthread_join(ids[i], NULL);
+    }
+
+    for (i = 0; i < hilos; i++) {
+        for (j = 0; j < HISTOGRAMA_SIMBOLOS; j++) {
+            frecuencias[j] += tareas[i].frecuencias[j];
+        }
+    }
+
+    free(tareas);
+    free(ids);
+}
+
+#else
+
+void histograma_contar_hilos(const unsigned char* datos, size_t n, int hilos,
+                             uint64_t frecuencias[HISTOGRAMA_SIMBOLOS]) {
+    (void) hilos;
+    histograma_contar(datos, n, frecuencias);
+}
+
+#endif
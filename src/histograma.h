@@ -0,0 +1,29 @@
+#ifndef DEFINE_HISTOGRAMA_H
+#define DEFINE_HISTOGRAMA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Cantidad de valores distintos de un byte */
+#define HISTOGRAMA_SIMBOLOS 256
+
+/*
+  Suma a frecuencias[] las apariciones de cada byte de datos[0..n).
+  
+  No pone frecuencias[] en cero, asi se puede llamar varias veces para
+  contar un archivo de a bloques.
+*/
+void histograma_contar(const unsigned char* datos, size_t n, uint64_t frecuencias[HISTOGRAMA_SIMBOLOS]);
+
+/*
+  Igual que histograma_contar() pero divide datos[0..n) en tramos que
+  cuentan hasta hilos hilos en paralelo, cada uno en su propia tabla; al
+  final se suman las tablas a frecuencias[].
+  
+  Si hilos <= 1, los datos son pocos o la plataforma no tiene hilos
+  POSIX, cuenta con histograma_contar() en el hilo actual.
+*/
+void histograma_contar_hilos(const unsigned char* datos, size_t n, int hilos,
+                             uint64_t frecuencias[HISTOGRAMA_SIMBOLOS]);
+
+#endif
@@ -1,796 +1,3015 @@
-#include "huffman.h"
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <stdint.h>
-
-#include "arbol.h"
-#include "pq.h"
-#include "bitstream.h"
-#include "confirm.h"
-
-/*====================================================
-     Constantes
-  ====================================================*/
-
-#define NUM_CHARS 256
-
-/*
-estructura para almacenar valores de un nodo de un arbol, 
-c es el caracter
-frec es la frecuencia
-*/
-typedef struct _keyvaluepair {
-    char c;
-    int frec;
-} keyvaluepair;
-
-/*====================================================
-     Campo de bits.. agrega funciones si quieres
-     para facilitar el procesamiento de bits.
-  ====================================================*/
-
-typedef struct _campobits {
-    unsigned int bits;
-    int tamano;
-} campobits;
-
-/**
-    Esto utiliza aritmetica de bits para agregar un
-   bit a un campo.
-   
-   Supongamos que bits->bits inicialmene es (en binario):
-   
-      000110001000
-      
-   y le quiero agregar un 1 en vez del segundo 0 (desde izq).
-   Entonces, creo una "mascara" de la siguiente forma:
-   
-      1 << 11   me da 0100000000000
-
-   Y entonces si juntamos los dos (utilizando OR binario):      
-      000110001000
-    | 0100000000000
-    ----------------
-      010110001000
-
-    Esta funcion utiliza bits->tamano para decidir donde colocar
-    el siguiente bit.
-    
-    Nota: asume que bits->bits esta inicialmente inicializado a 0,
-    entonces agregar un 0, no requiere mas que incrementar bits->tamano.
-*/      
-static void bits_agregar(campobits* bits, int bit) {
-    CONFIRM_RETURN(bits);
-    CONFIRM_RETURN((unsigned int)bits->tamano < 8*sizeof(bits->bits));
-    bits->tamano++;
-    if (bit) {
-        bits->bits = bits->bits | ( 0x1 << (bits->tamano-1));
-    } 
-}
-
-/* ### University Template ###
-    funcion de utilidad para leer un bit dentro de campobits dado el indice pos
-    pos = 0, primer bit 
-    pos = 1, segundo bit
-    pos = 2, tercer bit
-    pos = k, k bit
-
-*/
-static int bits_leer(campobits* bits, int pos) {
-    CONFIRM_TRUE(bits,0);
-    CONFIRM_TRUE(!(pos < 0 || pos > bits->tamano),0);
-    // para saber si campobits tiene un 1 o 0 en la posicion dada 
-    // recorro bits usando shift << y >>
-    int bit = (bits->bits & (0x1 << (pos))) >> (pos);
-    return bit;
-}
-
-/** Agus
- * Prints the campobits value to the screen.
- *
- * This function iterates from the least significant bit (at index 0
- * up to the most significant (index tamano-1) using the bits_leer() helper, and
- * prints each bit as '0' or '1'.
- *
- * @param bits A pointer to a campobits structure.
- */
- static void bits_print(campobits* bits) {
-    int i;
-
-    if (!bits) {
-        printf("NULL\n");
-        return;
-    }
-
-    for (i = 0; i < bits->tamano; i++) {
-        int bit = bits_leer(bits, i);  // Use bits_leer to read each bit
-        putchar(bit ? '1' : '0');
-    }
-
-    putchar('\n');
-}
-
-static int bits_remove_last(campobits* bits) {
-    if (!bits || bits->tamano <= 0){
-        return -1; // Error: No bits to remove
-    }
-
-    // Retrieve the last bit at position (tamano - 1)
-    int last_bit = (bits->bits >> (bits->tamano - 1)) & 0x1;
-    
-    // Decrease the size to reflect the removal of the last bit
-    bits->tamano--;
-    
-    // Clear the bit at the new last position
-    bits->bits &= ~(0x1 << bits->tamano);
-    
-    return last_bit;
-}
-
-static void testCampobitsBitstream() {
-    BitStream bs = NULL;
-    BitStream bsIn = NULL;
-    char* testbitstreamtxt = "testbitsteam.txt";
-    int i = 0;
-    // crear un campobits
-    campobits* b = (campobits*)malloc(sizeof(struct _campobits));
-    CONFIRM_RETURN(b);
-    b->bits = 0;
-    b->tamano = 0;
-    // ej quiero codificar 00101 
-    bits_agregar(b, 0);
-    bits_agregar(b, 0);
-    bits_agregar(b, 1);
-    bits_agregar(b, 0);
-    bits_agregar(b, 1);
-    // crear un archivo y escribir bit a bit
-    bs = OpenBitStream(testbitstreamtxt, "w");
-    // para escribir en un archivo PutBit agrega bits 
-    // ej recorro el campobits y agrego bit a bit
-    for (i = 0; i < b->tamano; i++) {
-        int bit = bits_leer(b, i);
-        PutBit(bs, bit);
-    }
-    // PutByte para escribir 1 byte completo, 
-    // ej agrego un caracter
-    PutByte(bs, 'z');
-    // no olvidar cerrar el archvio
-    CloseBitStream(bs);
-    // y liberar memoria utilizada
-    free(b);
-    // Mi archivo entonces contiene: 00101z
-    // si quiero leer el mismo
-    bsIn = OpenBitStream(testbitstreamtxt, "r");
-    // leer bit a bit
-    printf("%d", GetBit(bsIn));
-    printf("%d", GetBit(bsIn));
-    printf("%d", GetBit(bsIn));
-    printf("%d", GetBit(bsIn));
-    printf("%d", GetBit(bsIn));
-    // leer un byte
-    printf("%c\n", GetByte(bsIn));
-    CloseBitStream(bsIn);
-
-
-
-}
-
-/*Agus*/
-static void imprimirNodoEjemplo(Arbol nodo) {
-    CONFIRM_RETURN(nodo);
-    keyvaluepair* val = (keyvaluepair*)arbol_valor(nodo);
-    printf("%d,%c\n", val->frec, val->c);
-}
-
-static void testArbol() {
-
-    /* si quiero crear un arbol que contiene:
-    char freq
-    a    4
-    s    2
-    entonces tengo un nodo padre
-    con freq 6 y dos hijos, con freq 2  y 4 con sus caracteres correspondientes
-    */
-    keyvaluepair* v1 = malloc(sizeof(struct _keyvaluepair));
-    keyvaluepair* v2 = malloc(sizeof(struct _keyvaluepair));
-    keyvaluepair* v3 = malloc(sizeof(struct _keyvaluepair));
-
-    Arbol n1;
-    Arbol n2;
-    Arbol n3;
-
-    CONFIRM_RETURN(v1);
-    CONFIRM_RETURN(v2);
-    CONFIRM_RETURN(v3);
-
-    v1->c = 'a';
-    v1->frec = 4;
-    v2->c = 's';
-    v2->frec = 2;
-    v3->c = ' ';
-    v3->frec = 6;
-
-    n1 = arbol_crear(v1);
-    n2 = arbol_crear(v2);
-    n3 = arbol_crear(v3);
-
-    arbol_agregarIzq(n3, n2);
-    arbol_agregarDer(n3, n1);
-    
-    //ejemplo de recorrer el arbol e imprimir nodos con valor keyvaluepair
-    arbol_imprimir(n3, imprimirNodoEjemplo);
-    arbol_destruir(n3);
-    free(v1);
-    free(v2);
-    free(v3);
-}
-
-void campobitsDemo() {
-    printf("***************CAMPOBITS DEMO*******************\n");
-    testCampobitsBitstream();
-    printf("***************ARBOL DEMO******************\n");
-    testArbol();
-    printf("***************FIN DEMO*****************\n");
-}
-/*====================================================
-     Declaraciones de funciones 
-  ====================================================*/
-
-/* Puedes cambiar esto si quieres.. pero entiende bien lo que haces */
-static int calcular_frecuencias(int* frecuencias, char* entrada);
-static Arbol crear_huffman(int* frecuencias);
-static int codificar(Arbol T, char* entrada, char* salida);
-static void crear_tabla(campobits* tabla, Arbol T, campobits *bits);
-
-static Arbol leer_arbol(BitStream bs);
-static void decodificar(BitStream in, BitStream out, Arbol arbol);
-
-static void imprimirNodo(Arbol nodo);
-
-/*====================================================
-     Implementacion de funciones publicas
-  ====================================================*/
-
-/** Agus
- * Prints the frequency of ASCII characters stored in an array.
- *
- * @param freq Pointer to an integer array of size 256 where each index represents an ASCII value
- *             and the value at that index is the frequency of that character.
- */
- void print_frequency(const int* freq) {
-    int i;
-
-    if (!freq) {
-        fprintf(stderr, "Error: Null frequency array.\n");
-        return;
-    }
-
-    for (i = 0; i < NUM_CHARS; i++) {
-        if (freq[i] > 0) {
-            if (i >= 32 && i < 127)
-                printf("Character '%c' (ASCII %d): %d times\n", i, i, freq[i]);
-            else
-                printf("ASCII %d: %d times\n", i, freq[i]);
-        }
-    }
-}
-
-/*
-  Comprime archivo entrada y lo escriba a archivo salida.
-  
-  Retorna 0 si no hay errores.
-*/
-int comprimir(char* entrada, char* salida) {
-    
-    /* 256 es el numero de caracteres ASCII.
-       Asi podemos utilizar un unsigned char como indice.
-     */
-    int frecuencias[NUM_CHARS]; 
-    Arbol arbol = NULL;
-
-    /* Primer recorrido - calcular frecuencias */
-    CONFIRM_TRUE(0 == calcular_frecuencias(frecuencias, entrada), 0);
-            
-    arbol = crear_huffman(frecuencias);
-    printf("############ TREE ############\n");
-    arbol_imprimir(arbol, imprimirNodo); 
-    printf("########## END TREE ##########\n");
-
-    /* Segundo recorrido - Codificar archivo */
-    CONFIRM_TRUE(0 == codificar(arbol, entrada, salida), 0);
-    
-    arbol_destruir(arbol);
-    
-    return 0;
-}
-
-
-/*
-  Descomprime archivo entrada y lo escriba a archivo salida.
-  
-  Retorna 0 si no hay errores.
-*/
-int descomprimir(char* entrada, char* salida) {
-
-    BitStream in = 0;
-    BitStream out = 0;
-    Arbol arbol = NULL;
-        
-    /* Abrir archivo de entrada */
-    in = OpenBitStream(entrada, "r");
-    
-    /* Leer Arbol de Huffman */
-    arbol = leer_arbol(in);
-    arbol_imprimir(arbol, imprimirNodo);
-
-    /* Abrir archivo de salida */
-    out = OpenBitStream(salida, "w");
-    
-    /* Decodificar archivo */
-    decodificar(in, out, arbol);
-    
-    CloseBitStream(in);
-    CloseBitStream(out);
-    return 0;
-}
-
-/*====================================================
-     Funciones privadas
-  ====================================================*/
-
-
-/** Agus
- *  Helper funtion to check if a node is a leaf or not.
- *  
- * @param tree A node of a Tree.
- * @return int (boolean like).
- */
- int IsLeaf(Arbol tree){
-    return (NULL == arbol_izq(tree) && NULL == arbol_der(tree));
-}
-
-/** Agus
- * Reads a file character by character and counts the frequency of each ASCII character,
- * storing the result in the provided array.
- *
- * @param frecuencias Pointer to an integer array of size 256 where each index represents an ASCII value
- *                    and the value at that index is the frequency of that character.
- * @param entrada The name (or path) of the file to be read.
- * @return 0 if successful, non-zero if an error occurs.
- */
-static int calcular_frecuencias(int* frecuencias, char* entrada) {
-    if (!frecuencias || !entrada) {
-        fprintf(stderr, "Error: Null pointer argument.\n");
-        return -1;
-    }
-
-    // Initialize all frequency counts to zero
-    for (int i = 0; i < NUM_CHARS; i++) {
-        frecuencias[i] = 0;
-    }
-
-    // Open the file in read mode
-    FILE* file = fopen(entrada, "r");
-    if (!file) {
-        perror("Error opening file");
-        return -1;
-    }
-
-    // Read the file character by character and count occurrences
-    int character;
-    while ((character = fgetc(file)) != EOF) {
-        if (character >= 0 && character < NUM_CHARS) {
-            frecuencias[character]++;
-        }
-    }
-
-    //print_frequency(frecuencias); // Just for debuging
-
-    // Close the file
-    fclose(file);
-
-    return 0;
-}
-
-
-
-/** Agus
-* Build a Huffman Tree with the given frequencies. 
-* 
-* @param frecuencias An Array of int, the index represents an ASCII and the value the frequency of each.
-* return Arbol A complete huffman tree.
-*/
-static Arbol crear_huffman(int* frecuencias) {
-    int i;
-    PQ pq = pq_create();
-    if (!pq) {
-        /* Memory allocation error for priority queue */
-        return NULL;
-    }
-    
-    /* Insert each character with its frequency into the priority queue */
-    for (i = 0; i < 256; i++) {
-        if (frecuencias[i] > 0) {
-            keyvaluepair* kv = (keyvaluepair*) malloc(sizeof(keyvaluepair));
-            if (!kv) {
-                /* Handle memory allocation failure */
-                pq_destroy(pq);
-                return NULL;
-            }
-            kv->c = (char)i;
-            kv->frec = frecuencias[i];
-            
-            Arbol node = arbol_crear((void*)kv);
-            if (!node) {
-                free(kv);
-                pq_destroy(pq);
-                return NULL;
-            }
-            if (!pq_add(pq, node, kv->frec)) {
-                arbol_destruir(node);
-                pq_destroy(pq);
-                return NULL;
-            }
-        }
-    }
-    
-    /* If no characters were inserted, free PQ and return NULL */
-    if (pq_size(pq) == 0) {
-        pq_destroy(pq);
-        return NULL;
-    }
-    
-    /* Construct Huffman tree */
-    while (pq_size(pq) > 1) {
-        Arbol left, right;
-        /* Remove the tree with minimum frequency */
-        if (!pq_remove(pq, (void**)&left)) {
-            pq_destroy(pq);
-            return NULL;
-        }
-        if (!pq_remove(pq, (void**)&right)) {
-            pq_destroy(pq);
-            return NULL;
-        }
-        
-        /* Allocate memory for the parent node's keyvaluepair */
-        keyvaluepair* parent_kv = (keyvaluepair*) malloc(sizeof(keyvaluepair));
-        if (!parent_kv) {
-            pq_destroy(pq);
-            return NULL;
-        }
-        parent_kv->c = '\0'; /* Internal node, no character */
-        parent_kv->frec = ((keyvaluepair*) arbol_valor(left))->frec +
-                          ((keyvaluepair*) arbol_valor(right))->frec;
-        
-        /* Create parent tree node and assign children */
-        Arbol parent = arbol_crear((void*)parent_kv);
-        if (!parent) {
-            free(parent_kv);
-            pq_destroy(pq);
-            return NULL;
-        }
-        arbol_agregarIzq(parent, left);
-        arbol_agregarDer(parent, right);
-        
-        /* Insert the new tree into the priority queue */
-        if (!pq_add(pq, parent, parent_kv->frec)) {
-            arbol_destruir(parent);
-            pq_destroy(pq);
-            return NULL;
-        }
-    }
-    
-    /* Get the root of the Huffman tree */
-    Arbol huffman_tree;
-    if (!pq_remove(pq, (void**)&huffman_tree)) {
-        pq_destroy(pq);
-        return NULL;
-    }
-    
-    /* Destroy the priority queue; the final tree is not freed by pq_destroy */
-    pq_destroy(pq);
-    
-    return huffman_tree;
-}
-
-/** Agus
-* Helper function to create the Huffman coded table.
-* It traverses the Huffman tree from the root to each leaf,
-* accumulating the path in a campobits structure:
-*   - Append 0 when moving to the left.
-*   - Append 1 when moving to the right.
-* For each leaf encountered, it stores the accumulated campobits
-* in the table using the ASCII value of the leaf's character as the index.
-*/
-static void create_huffman_table(Arbol T, campobits current_code, campobits table[]) {
-    /* If the tree is empty, just return */
-    if (T == NULL) {
-        return;
-    }
-
-    // Check if T is a leaf (no left and no right child)
-    if (arbol_izq(T) == NULL && arbol_der(T) == NULL) {
-        keyvaluepair* kv = (keyvaluepair*) arbol_valor(T);
-        table[(unsigned char) kv->c] = current_code;  // Save the accumulated code for this character
-
-        printf("%c: ", kv->c); // Just Debugging
-        bits_print(&current_code); // Just Debugging
-
-        return;
-    }
-
-    {
-        /* Traverse left: append 0 */
-        campobits left_code = current_code;
-        bits_agregar(&left_code, 0);
-        create_huffman_table(arbol_izq(T), left_code, table);
-    }
-
-    {
-        /* Traverse right: append 1 */
-        campobits right_code = current_code;
-        bits_agregar(&right_code, 1);
-        create_huffman_table(arbol_der(T), right_code, table);
-    }
-}
-
-/* Agus
-   Recursive helper function to traverse the Huffman tree in pre-order and write its structure to a BitStream.
-   
-   - Internal nodes are represented by writing a '0' to the output.
-   - Leaf nodes are represented by writing a '1' followed by the ASCII byte of the character.
-   
-   This function does not use an accumulating campobit, as it directly writes to the BitStream 
-   while traversing the tree.
-*/
-static void write_tree_preorder(Arbol T, BitStream out) {
-    if (T == NULL) {
-        return;
-    }
-
-    // If T is a leaf, save 1 in the out file and then the char's ASCII byte
-    if (arbol_izq(T) == NULL && arbol_der(T) == NULL) {
-
-        keyvaluepair* kv = (keyvaluepair*) arbol_valor(T);
-
-        PutBit(out, 1);
-        PutByte(out, kv->c);
-
-        //printf("1%c", kv->c); // Just debugging
-
-        return;
-    } else {
-        PutBit(out, 0);
-        //printf("0"); // Just debugging
-        
-        write_tree_preorder(arbol_izq(T), out);
-        write_tree_preorder(arbol_der(T), out);
-    }
-}
-
-/* Agus
-   Encodes the input file using the Huffman tree and writes the result to the output file.
-   
-   Parameters:
-     T       - The Huffman tree.
-     entrada - Name of the input file to encode.
-     salida  - Name of the output file where the encoded data will be written.
-   
-   Returns:
-     0 on success, or a nonzero value if an error occurs.
-   
-   The function performs the following:
-     1. Creates an array (codes_table_campobits) of campobits of size NUM_CHARS,
-        where each index corresponds to an ASCII value and contains its Huffman code.
-     2. Opens the input and output files.
-     3. // ### Tree Code Building and Writing ###
-        Traverses the Huffman tree in pre-order, accumulating the path in a campobit.
-        When a leaf is found, it writes the accumulated campobit followed by the character 
-        (by calling write_tree_code) to the output BitStream, then resets the campobit.
-     4. Calls create_huffman_table to fill codes_table_campobits.
-     5. Reads the input file character by character and for each character, writes its 
-        corresponding campobit from codes_table_campobits to the output file.
-     6. Closes files and cleans up resources.
-*/
-static int codificar(Arbol T, char* entrada, char* salida) {
-    FILE* in = NULL;
-    BitStream out = NULL;
-    int i;
-    int c;
-    
-    // Create the table for Huffman codes. Each entry corresponds to a character (0..NUM_CHARS-1).
-    campobits codes_table_campobits[NUM_CHARS];
-    memset(codes_table_campobits, 0, NUM_CHARS * sizeof(campobits));
-    
-    // Open the input file for reading
-    in = fopen(entrada, "r");
-    if (in == NULL) {
-        return -1;
-    }
-    
-    // Open the output file as a BitStream for writing
-    out = OpenBitStream(salida, "w");
-    if (out == NULL) {
-        fclose(in);
-        return -1;
-    }
-    
-    // ### Tree Code Building and Writing ###
-    write_tree_preorder(T, out);
-    // END of Section
-
-    // Build the Huffman code table by traversing the tree
-    create_huffman_table(T, (campobits){0, 0}, codes_table_campobits);
-    
-    /* Write the encoded text.
-    For each character in the input file, write its corresponding
-    bit sequence (campobit) stored in the table. */
-    fseek(in, 0, SEEK_SET);
-    while ((c = fgetc(in)) != EOF) {
-        if (c < 0 || c >= NUM_CHARS) {
-            continue;
-        }
-        
-        campobits code = codes_table_campobits[(unsigned char)c];
-        for (i = 0; i < code.tamano; i++) {
-            int bit = bits_leer(&code, i);
-            PutBit(out, bit);
-        }
-    }
-    
-    // Clean up: close input file and BitStream output
-    fclose(in);
-    CloseBitStream(out);
-    
-    return 0;
-}
-
-/** Agus
- * Creates a new Huffman tree node with a keyvaluepair containing the given value.
- *
- * The function allocates a keyvaluepair structure, assigns the provided character
- * (which can be a valid char or '\0') to the 'c' field, sets the frequency ('frec')
- * to 0, and then creates a new tree node (of type Arbol) containing this keyvaluepair.
- * 
- * Going to be honest, understanding how an Arbol really works was a pain until I got it.
- *
- * @param value The character value to be stored in the node's keyvaluepair.
- * @return A new Arbol node containing the keyvaluepair, or exits on memory allocation error.
- */
- Arbol create_node(char value) {
-    keyvaluepair* kv = (keyvaluepair*) malloc(sizeof(keyvaluepair));
-    if (kv == NULL) {
-        fprintf(stderr, "Memory allocation error in create_node (keyvaluepair allocation)\n");
-        exit(1);
-    }
-    kv->c = value;    // Set the value (can be a valid char or '\0')
-    kv->frec = 0;     // Initialize frequency to 0
-
-    Arbol node = arbol_crear((void*)kv);
-    if (node == NULL) {
-        fprintf(stderr, "Memory allocation error in create_node (arbol_crear failed)\n");
-        free(kv);
-        exit(1);
-    }
-    return node;
-}
-
-/** Agus
-*  Helper function to read a bit from the input file.
-*  check if it's a leaf (1), then get a byte, create a node and stores the byte in it.
-*  else, it's not a leaf, creates two empty nodes and make them the current node children.
-*/
-void decode_tree(Arbol node, void* data){
-    if (NULL == node) return;
-
-    BitStream bs = *(BitStream*)data;
-    int bit = GetBit(bs);
-
-    
-    if (bit == 1){
-        int byte = GetByte(bs);
-        keyvaluepair* kv = (keyvaluepair*) arbol_valor(node);
-        kv->c = (char)byte;
-        //printf("1%c", kv->c); // Just for debugging
-        return;
-    } else {
-        Arbol left = create_node('\0');
-        Arbol right = create_node('\0');
-
-        if (!left || !right) return;
-
-        arbol_agregarIzq(node, left);
-        arbol_agregarDer(node, right);
-        
-        //printf("0"); // Just for debugging
-        return;
-    }
-}
-
-/* Esto se utiliza como parte de la descompresion (ver descomprimir())..
-   
-   Para leer algo que esta guardado en preorden, hay que
-   pensarlo un poquito.
-   
-   Pero basicamente la idea es que vamos a leer el archivo
-   en secuencia. Inicialmente, el archivo probablemente va 
-   a empezar con el bit 0 representando la raiz del arbol. 
-   Luego, tenemos que leer recursivamente (utiliza otra funcion
-   para ayudarte si lo necesitas) un nodo izquierdo y uno derecho.
-   Si uno (o ambos) son hojas entonces tenemos que leer tambien su
-   codigo ASCII. Hacemos esto hasta que todos los nodos tienen sus 
-   hijos. (Si esta bien escrito el arbol el algoritmo terminara
-   porque no hay mas nodos sin hijos)
-*/
-static Arbol leer_arbol(BitStream bs) {
-    if (!bs) return NULL; // Entry Verification
-
-    //int bit = GetBit(bs);
-
-    // If it's a 0, it's an internal node
-    Arbol root = create_node('\0');
-    if (NULL == root) return NULL; // Memory allocation failure
-
-    arbol_preorden(root, decode_tree, &bs);
-
-    return root;
-}
-
-/* Esto se utiliza como parte de la descompresion (ver descomprimir())..
-   
-   Ahora lee todos los bits que quedan en in, y escribelos como bytes
-   en out. Utiliza los bits para navegar por el arbol de huffman, y
-   cuando llegues a una hoja escribe el codigo ASCII al out con PutByte()
-   y vuelve a comenzar a procesar bits desde la raiz.
-   
-   Sigue con este proceso hasta que no hay mas bits en in.
-*/   
-static void decodificar(BitStream in, BitStream out, Arbol arbol) {
-    
-    if (!in || !out || !arbol) return; // Entry verification
-
-    while (!IsEmptyBitStream(in)) {
-        Arbol current = arbol; // Comenzar desde la raíz en cada símbolo
-        
-        // Recorrer el árbol bit a bit hasta encontrar una hoja
-        while (!IsLeaf(current)) {
-            int bit = GetBit(in);
-            if (bit == 0) {
-                current = arbol_izq(current);
-            } else {
-                current = arbol_der(current);
-            }
-        }
-        
-        // Escribimos el byte correspondiente al carácter de la hoja
-        keyvaluepair* kv = (keyvaluepair*) arbol_valor(current);
-        PutByte(out, kv->c);
-    }
-
-}
-
-
-/* Esto es para imprimir nodos..
-   Tal vez tengas mas de uno de estas funciones debendiendo
-   de como decidiste representar los valores del arbol durante
-   la compresion y descompresion.
-*/
-static void imprimirNodo(Arbol nodo) {
-    // Check that the node is not NULL
-    CONFIRM_RETURN(nodo);
-    
-    // Retrieve the key-value pair stored in the node
-    keyvaluepair* val = (keyvaluepair*) arbol_valor(nodo);
-    
-    // Check if the node is a leaf (no left or right child)
-    if (arbol_izq(nodo) == NULL && arbol_der(nodo) == NULL) {
-        // Print leaf node information: frequency and character
-        printf("Leaf: %d, %c", val->frec, val->c);
-    } else {
-        // For internal nodes, we might not have a meaningful character, so we print only the frequency
-        printf("Internal: %d", val->frec);
-    }
-}
\ No newline at end of file
+#include "huffman.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#include "arbol.h"
+#include "adaptativo.h"
+#include "histograma.h"
+#include "mapa.h"
+#include "pool.h"
+#include "bitstream.h"
+#include "confirm.h"
+
+/*====================================================
+     Constantes
+  ====================================================*/
+
+/* Nombre de archivo que quiere decir entrada o salida estandar */
+#define ARCHIVO_ESTANDAR "-"
+
+#define NUM_CHARS 256
+
+/* Longitud maxima de un codigo, PutBits() y PeekBits() trabajan con 32 bits */
+#define MAX_BITS 32
+
+/* Cantidad maxima de nodos de un arbol de Huffman de NUM_CHARS hojas */
+#define MAX_NODOS (2 * NUM_CHARS - 1)
+
+/* Primer byte del archivo comprimido: como esta organizado el resto */
+#define FORMATO_SIMPLE  0x01    /* una sola tabla y un solo bitstream */
+#define FORMATO_BLOQUES 0x02    /* bloques independientes, ver comprimir_bloques() */
+#define FORMATO_ADAPTATIVO 0x03 /* sin tabla, ver comprimir_adaptativo() */
+
+/* Tipo de cada bloque del FORMATO_BLOQUES */
+#define BLOQUE_FIN     0x00     /* no hay mas bloques */
+#define BLOQUE_HUFFMAN 0x01     /* tabla propia y despues los codigos */
+#define BLOQUE_REUSA   0x02     /* solo los codigos, con la tabla vigente */
+#define BLOQUE_CRUDO   0x03     /* los bytes sin comprimir */
+#define BLOQUE_UNICO   0x04     /* un solo byte que se repite todo el bloque */
+#define BLOQUE_RLE     0x05     /* rachas de un mismo byte, ver codificar_rle() */
+
+/* Al final del FORMATO_BLOQUES, despues del indice: su largo en bytes
+   (4 bytes) y esta marca (4 bytes), los dos con el byte menos
+   significativo primero. Ver escribir_indice(). */
+#define INDICE_MARCA 0x58444948ul    /* "HIDX" */
+#define INDICE_COLA 8
+
+/* Bloques por hilo que se descomprimen a la vez; cada uno ocupa poco
+   (su tabla) porque se decodifica directamente en el archivo de salida */
+#define BLOQUES_POR_HILO_DESCOMPRESION 8
+
+/* Bloques por hilo que se comprimen a la vez; mas bloques dan mas trabajo
+   para repartir pero ocupan mas memoria hasta que se escriben */
+#define BLOQUES_POR_HILO 2
+
+/* Bytes de cada tramo que codifica un hilo en el FORMATO_SIMPLE */
+#define TRAMO_CODIFICACION (4 << 20)
+
+/* Bytes minimos de las partes en que se divide una tanda para buscar
+   donde cortar los bloques, ver dividir_bloques() */
+#define GRANO_MINIMO (4 << 10)
+
+/* Bits de la cabecera de un bloque (tipo y dos varint), para el costo
+   de cortar */
+#define COSTO_CABECERA (8 * 5)
+
+/* Desde este nivel dividir_bloques() usa los costos exactos de cada
+   bloque en vez de su entropia */
+#define NIVEL_EXACTO 3
+
+/* Precision de los costos de dividir_bloques(): 1/65536 de bit */
+#define FIJO_BITS 16
+
+/* Bytes que se revisan entre cada control en tamano_rle() */
+#define RLE_TRAMO 4096
+
+/* Bytes que puede ocupar como maximo la tabla de un bloque */
+#define MAX_TABLA 256
+
+/* Tamano del buffer de salida cuando el archivo descomprimido no se
+   puede mapear en memoria */
+#define SALIDA_BLOQUE (1 << 20)
+
+/* Bits que resuelve de una sola vez la tabla de decodificacion */
+#define TABLA_BITS 11
+#define TABLA_TAMANO (1 << TABLA_BITS)
+
+/*
+estructura para almacenar valores de un nodo de un arbol, 
+c es el caracter
+frec es la frecuencia
+*/
+typedef struct _keyvaluepair {
+    char c;
+    int frec;
+} keyvaluepair;
+
+/*
+arbol de Huffman plano, sin punteros, que se puede copiar con memcpy.
+El nodo 0 es la raiz y los hijos de un nodo interno estan uno al lado
+del otro: los hijos de i son hijos[i] (bit 0) y hijos[i]+1 (bit 1).
+hijos[i] == 0 indica que i es la hoja del caracter simbolo[i], y
+hijos[i] == -1 que ningun codigo pasa por i.
+*/
+typedef struct _arbol_plano {
+    short hijos[MAX_NODOS];
+    unsigned char simbolo[MAX_NODOS];
+    int nodos;
+} arbol_plano;
+
+/*
+entrada de la tabla de decodificacion, indexada por los siguientes
+TABLA_BITS bits del archivo comprimido.
+Si longitud > 0 esos bits empiezan con el codigo de simbolo, que mide
+longitud bits. Si longitud == 0 el codigo es mas largo que TABLA_BITS y
+nodo es el nodo del arbol al que se llega con esos TABLA_BITS bits.
+*/
+typedef struct _entrada_tabla {
+    short nodo;
+    unsigned char simbolo;
+    unsigned char longitud;
+} entrada_tabla;
+
+/*
+lo necesario para decodificar: la tabla resuelve los codigos de hasta
+TABLA_BITS bits y los mas largos se terminan de recorrer en el arbol.
+maxima es la longitud del codigo mas largo (0 si no hay codigos).
+*/
+typedef struct _decodificador {
+    entrada_tabla tabla[TABLA_TAMANO];
+    arbol_plano arbol;
+    int maxima;
+} decodificador;
+
+/*====================================================
+     Campo de bits.. agrega funciones si quieres
+     para facilitar el procesamiento de bits.
+  ====================================================*/
+
+typedef struct _campobits {
+    unsigned int bits;
+    int tamano;
+} campobits;
+
+/**
+    Esto utiliza aritmetica de bits para agregar un
+   bit a un campo.
+   
+   Supongamos que bits->bits inicialmene es (en binario):
+   
+      000110001000
+      
+   y le quiero agregar un 1 en vez del segundo 0 (desde izq).
+   Entonces, creo una "mascara" de la siguiente forma:
+   
+      1 << 11   me da 0100000000000
+
+   Y entonces si juntamos los dos (utilizando OR binario):      
+      000110001000
+    | 0100000000000
+    ----------------
+      010110001000
+
+    Esta funcion utiliza bits->tamano para decidir donde colocar
+    el siguiente bit.
+    
+    Nota: asume que bits->bits esta inicialmente inicializado a 0,
+    entonces agregar un 0, no requiere mas que incrementar bits->tamano.
+*/      
+static void bits_agregar(campobits* bits, int bit) {
+    CONFIRM_RETURN(bits);
+    CONFIRM_RETURN((unsigned int)bits->tamano < 8*sizeof(bits->bits));
+    bits->tamano++;
+    if (bit) {
+        bits->bits = bits->bits | ( 0x1 << (bits->tamano-1));
+    } 
+}
+
+/* ### University Template ###
+    funcion de utilidad para leer un bit dentro de campobits dado el indice pos
+    pos = 0, primer bit 
+    pos = 1, segundo bit
+    pos = 2, tercer bit
+    pos = k, k bit
+
+*/
+static int bits_leer(campobits* bits, int pos) {
+    CONFIRM_TRUE(bits,0);
+    CONFIRM_TRUE(!(pos < 0 || pos > bits->tamano),0);
+    // para saber si campobits tiene un 1 o 0 en la posicion dada 
+    // recorro bits usando shift << y >>
+    int bit = (bits->bits & (0x1 << (pos))) >> (pos);
+    return bit;
+}
+
+static int bits_remove_last(campobits* bits) {
+    if (!bits || bits->tamano <= 0){
+        return -1; // Error: No bits to remove
+    }
+
+    // Retrieve the last bit at position (tamano - 1)
+    int last_bit = (bits->bits >> (bits->tamano - 1)) & 0x1;
+    
+    // Decrease the size to reflect the removal of the last bit
+    bits->tamano--;
+    
+    // Clear the bit at the new last position
+    bits->bits &= ~(0x1 << bits->tamano);
+    
+    return last_bit;
+}
+
+static void testCampobitsBitstream() {
+    BitStream bs = NULL;
+    BitStream bsIn = NULL;
+    char* testbitstreamtxt = "testbitsteam.txt";
+    int i = 0;
+    // crear un campobits
+    campobits* b = (campobits*)malloc(sizeof(struct _campobits));
+    CONFIRM_RETURN(b);
+    b->bits = 0;
+    b->tamano = 0;
+    // ej quiero codificar 00101 
+    bits_agregar(b, 0);
+    bits_agregar(b, 0);
+    bits_agregar(b, 1);
+    bits_agregar(b, 0);
+    bits_agregar(b, 1);
+    // crear un archivo y escribir bit a bit
+    bs = OpenBitStream(testbitstreamtxt, "w");
+    // para escribir en un archivo PutBit agrega bits 
+    // ej recorro el campobits y agrego bit a bit
+    for (i = 0; i < b->tamano; i++) {
+        int bit = bits_leer(b, i);
+        PutBit(bs, bit);
+    }
+    // PutByte para escribir 1 byte completo, 
+    // ej agrego un caracter
+    PutByte(bs, 'z');
+    // no olvidar cerrar el archvio
+    CloseBitStream(bs);
+    // y liberar memoria utilizada
+    free(b);
+    // Mi archivo entonces contiene: 00101z
+    // si quiero leer el mismo
+    bsIn = OpenBitStream(testbitstreamtxt, "r");
+    // leer bit a bit
+    printf("%d", GetBit(bsIn));
+    printf("%d", GetBit(bsIn));
+    printf("%d", GetBit(bsIn));
+    printf("%d", GetBit(bsIn));
+    printf("%d", GetBit(bsIn));
+    // leer un byte
+    printf("%c\n", GetByte(bsIn));
+    CloseBitStream(bsIn);
+
+
+
+}
+
+/*Agus*/
+static void imprimirNodoEjemplo(Arbol nodo) {
+    CONFIRM_RETURN(nodo);
+    keyvaluepair* val = (keyvaluepair*)arbol_valor(nodo);
+    printf("%d,%c\n", val->frec, val->c);
+}
+
+static void testArbol() {
+
+    /* si quiero crear un arbol que contiene:
+    char freq
+    a    4
+    s    2
+    entonces tengo un nodo padre
+    con freq 6 y dos hijos, con freq 2  y 4 con sus caracteres correspondientes
+    */
+    keyvaluepair* v1 = malloc(sizeof(struct _keyvaluepair));
+    keyvaluepair* v2 = malloc(sizeof(struct _keyvaluepair));
+    keyvaluepair* v3 = malloc(sizeof(struct _keyvaluepair));
+
+    Arbol n1;
+    Arbol n2;
+    Arbol n3;
+
+    CONFIRM_RETURN(v1);
+    CONFIRM_RETURN(v2);
+    CONFIRM_RETURN(v3);
+
+    v1->c = 'a';
+    v1->frec = 4;
+    v2->c = 's';
+    v2->frec = 2;
+    v3->c = ' ';
+    v3->frec = 6;
+
+    n1 = arbol_crear(v1);
+    n2 = arbol_crear(v2);
+    n3 = arbol_crear(v3);
+
+    arbol_agregarIzq(n3, n2);
+    arbol_agregarDer(n3, n1);
+    
+    //ejemplo de recorrer el arbol e imprimir nodos con valor keyvaluepair
+    arbol_imprimir(n3, imprimirNodoEjemplo);
+    arbol_destruir(n3);
+    free(v1);
+    free(v2);
+    free(v3);
+}
+
+/* Crea un nodo de la arena cuyo keyvaluepair queda en la misma arena */
+static Arbol crearNodoEjemplo(ArbolArena arena, char c, int frec) {
+    keyvaluepair* kv = (keyvaluepair*) arbol_arena_reservar(arena, sizeof(keyvaluepair));
+    CONFIRM_NOTNULL(kv, NULL);
+    kv->c = c;
+    kv->frec = frec;
+    return arbol_crear_en(arena, kv);
+}
+
+static void testArbolArena() {
+
+    /* el mismo arbol, pero los nodos y sus valores salen de una arena:
+    no hay un malloc por nodo y todo se libera de una vez */
+    ArbolArena arena = arbol_arena_crear(0);
+    Arbol n3;
+    CONFIRM_RETURN(arena);
+
+    n3 = crearNodoEjemplo(arena, ' ', 6);
+    arbol_agregarIzq(n3, crearNodoEjemplo(arena, 's', 2));
+    arbol_agregarDer(n3, crearNodoEjemplo(arena, 'a', 4));
+
+    arbol_imprimir(n3, imprimirNodoEjemplo);
+    arbol_arena_liberar(arena);
+}
+
+void campobitsDemo() {
+    printf("***************CAMPOBITS DEMO*******************\n");
+    testCampobitsBitstream();
+    printf("***************ARBOL DEMO******************\n");
+    testArbol();
+    printf("***************ARBOL ARENA DEMO******************\n");
+    testArbolArena();
+    printf("***************FIN DEMO*****************\n");
+}
+/*
+un bloque del FORMATO_BLOQUES ya comprimido, listo para escribir.
+datos tiene los tamano bytes de la tabla (si tipo es BLOQUE_HUFFMAN) y
+los codigos de los original bytes del bloque. Un BLOQUE_CRUDO o
+BLOQUE_UNICO no tiene datos propios: se escriben los tamano bytes de
+crudo, que son de la entrada.
+*/
+typedef struct _bloque {
+    int tipo;
+    size_t original;
+    unsigned char* datos;
+    const unsigned char* crudo;
+    size_t tamano;
+} bloque;
+
+/*
+lo que hace falta para comprimir un bloque en un hilo del Pool: primero
+analizar_bloque() calcula frecuencias, longitudes, cuantos bytes
+distintos hay y lo que ocuparia con BLOQUE_RLE, despues se elige la
+tabla (en orden, porque depende de los bloques anteriores) y por
+ultimo comprimir_bloque() deja el resultado en b.
+*/
+typedef struct _trabajo_bloque {
+    const unsigned char* datos;
+    size_t n;
+    int max_bits;
+    uint64_t frecuencias[NUM_CHARS];
+    unsigned char longitudes[NUM_CHARS];
+    int distintos;
+    uint64_t rle;
+    int tipo;
+    unsigned char tabla[NUM_CHARS];
+    bloque b;
+    int error;
+    pool_tarea tarea;
+} trabajo_bloque;
+
+/*
+lo que hace falta para buscar en un hilo del Pool donde cortar una
+region de BLOQUES_POR_HILO bloques (ver dividir_bloques()). cortes queda
+relativo al principio de datos y tiene lugar para lugar cortes.
+*/
+typedef struct _trabajo_division {
+    const unsigned char* datos;
+    size_t n;
+    const huffman_opciones* op;
+    size_t* cortes;
+    int lugar;
+    int cantidad;
+    pool_tarea tarea;
+} trabajo_division;
+
+/*
+indice de los bloques que se va armando mientras se escriben: para cada
+bloque, los bytes que ocupa (cabecera incluida) y su tamano original,
+con poner_varint().
+*/
+typedef struct _indice {
+    unsigned char* datos;
+    size_t tamano;
+    size_t capacidad;
+    uint64_t bloques;
+} indice;
+
+/*
+lo que hace falta para descomprimir un bloque en un hilo del Pool. d es
+la tabla del bloque (propia si es BLOQUE_HUFFMAN, si no la de otro), ya
+armada antes de agregar la tarea.
+*/
+typedef struct _trabajo_descompresion {
+    const unsigned char* datos;
+    size_t tamano;
+    int tipo;
+    unsigned char* destino;
+    size_t original;
+    const decodificador* d;
+    decodificador propia;
+    int error;
+    pool_tarea tarea;
+} trabajo_descompresion;
+
+/*
+un tramo del FORMATO_SIMPLE que se codifica en un hilo del Pool.
+bits es lo que ocupan sus codigos y desfase en que bit del primer byte
+empiezan; salida tiene esos bytes, con ceros antes del desfase y despues
+del ultimo codigo, para juntarlos con los de los tramos vecinos.
+*/
+typedef struct _trabajo_tramo {
+    const unsigned char* datos;
+    size_t n;
+    const unsigned char* longitudes;
+    const unsigned long* codigos;
+    uint64_t bits;
+    int desfase;
+    unsigned char* salida;
+    size_t tamano;
+    pool_tarea tarea;
+} trabajo_tramo;
+
+/* En cuantas partes se divide op->tamano_bloque para buscar donde cortar,
+   en cada nivel de compresion (el 1 no busca) */
+static const int granos_por_bloque[HUFFMAN_NIVEL_MAXIMO + 1] = { 0, 1, 8, 32 };
+
+/* log2(1 + i/256) en 1/65536 de bit, para log2_fijo() */
+static const unsigned short log2_mantisa[256] = {
+        0,   369,   736,  1102,  1466,  1829,  2190,  2551,  2909,  3267,  3623,  3978,
+     4331,  4683,  5034,  5384,  5732,  6079,  6425,  6769,  7112,  7454,  7795,  8134,
+     8473,  8810,  9146,  9480,  9814, 10146, 10477, 10807, 11136, 11464, 11791, 12116,
+    12440, 12764, 13086, 13407, 13727, 14046, 14363, 14680, 14996, 15310, 15624, 15937,
+    16248, 16559, 16868, 17177, 17484, 17791, 18096, 18401, 18704, 19007, 19308, 19609,
+    19909, 20207, 20505, 20802, 21098, 21393, 21687, 21980, 22272, 22564, 22854, 23144,
+    23433, 23720, 24007, 24293, 24579, 24863, 25146, 25429, 25711, 25992, 26272, 26551,
+    26830, 27108, 27384, 27660, 27936, 28210, 28484, 28757, 29029, 29300, 29571, 29840,
+    30109, 30378, 30645, 30912, 31178, 31443, 31707, 31971, 32234, 32496, 32758, 33019,
+    33279, 33538, 33797, 34055, 34312, 34569, 34825, 35080, 35334, 35588, 35841, 36094,
+    36346, 36597, 36847, 37097, 37346, 37595, 37842, 38090, 38336, 38582, 38827, 39072,
+    39316, 39559, 39802, 40044, 40286, 40527, 40767, 41006, 41246, 41484, 41722, 41959,
+    42196, 42432, 42667, 42902, 43137, 43370, 43603, 43836, 44068, 44300, 44530, 44761,
+    44990, 45220, 45448, 45676, 45904, 46131, 46357, 46583, 46809, 47034, 47258, 47482,
+    47705, 47928, 48150, 48372, 48593, 48813, 49034, 49253, 49472, 49691, 49909, 50127,
+    50344, 50560, 50776, 50992, 51207, 51422, 51636, 51850, 52063, 52276, 52488, 52700,
+    52911, 53122, 53332, 53542, 53751, 53960, 54169, 54377, 54584, 54791, 54998, 55204,
+    55410, 55615, 55820, 56025, 56229, 56432, 56635, 56838, 57040, 57242, 57443, 57644,
+    57845, 58045, 58245, 58444, 58643, 58841, 59039, 59237, 59434, 59631, 59827, 60023,
+    60219, 60414, 60609, 60803, 60997, 61190, 61384, 61576, 61769, 61961, 62152, 62343,
+    62534, 62725, 62915, 63104, 63294, 63483, 63671, 63859, 64047, 64234, 64421, 64608,
+    64794, 64980, 65166, 65351
+};
+
+/*====================================================
+     Declaraciones de funciones 
+  ====================================================*/
+
+/* Puedes cambiar esto si quieres.. pero entiende bien lo que haces */
+static void calcular_frecuencias(uint64_t* frecuencias, const unsigned char* datos, size_t n, int hilos);
+static int ordenar_simbolos(const uint64_t* frecuencias, uint64_t pesos[], unsigned char simbolos[]);
+static void calcular_longitudes(const uint64_t* frecuencias, unsigned char longitudes[], int max_bits);
+static void limitar_longitudes(const uint64_t pesos[], const unsigned char simbolos[], int n,
+                               unsigned char longitudes[], int max_bits);
+static int crear_codigos(const unsigned char longitudes[], unsigned long codigos[]);
+static void escribir_tamano(BitStream out, uint64_t tamano);
+static int contar_longitudes(const unsigned char longitudes[], int cantidad[], int* maxima);
+static int bits_lista(const int cantidad[], int n, int maxima);
+static int tamano_longitudes(const unsigned char longitudes[]);
+static void escribir_longitudes(BitStream out, const unsigned char longitudes[]);
+static void codificar_datos(BitStream out, const unsigned long codigos[], const unsigned char longitudes[],
+                            const unsigned char* datos, size_t n);
+static FILE* abrir_archivo(const char* nombre, const char* modo);
+static int cerrar_archivo(FILE* f);
+static int codificar(const unsigned char longitudes[], const unsigned char* datos, size_t n, FILE* salida);
+static void medir_tramo(void* arg);
+static void codificar_tramo(void* arg);
+static int escribir_segmento(FILE* out, unsigned char* datos, int desfase, uint64_t bits, unsigned char* pendiente);
+static int codificar_hilos(const unsigned char longitudes[], const unsigned char* datos, size_t n, FILE* out,
+                           int hilos);
+
+static int leer_tamano(BitStream bs, uint64_t* tamano);
+static int leer_longitudes(BitStream bs, unsigned char longitudes[]);
+static int arbol_plano_crear(arbol_plano* t, const unsigned char longitudes[]);
+static void arbol_plano_tabla(const arbol_plano* t, entrada_tabla tabla[]);
+static int crear_decodificador(const unsigned char longitudes[], decodificador* d);
+static int decodificar_simbolo(const decodificador* d, unsigned long ventana, int* longitud);
+static int decodificar(BitStream in, const decodificador* d, unsigned char* destino, size_t n);
+static int decodificar_con_buffer(BitStream in, const decodificador* d, FILE* out, uint64_t n);
+static int descomprimir_simple(FILE* in, FILE* out);
+
+static int poner_varint(unsigned char* destino, uint64_t valor);
+static int leer_varint(FILE* in, uint64_t* valor);
+static uint64_t costo_codigos(const uint64_t* frecuencias, const unsigned char longitudes[]);
+static int reusar_tabla(const uint64_t* frecuencias, const unsigned char nueva[], const unsigned char vigente[]);
+static uint64_t bytes_codigos(const uint64_t* frecuencias, const unsigned char longitudes[], int con_tabla);
+static uint64_t bytes_crudo(size_t n);
+static uint64_t tamano_rle(const unsigned char* datos, size_t n, uint64_t limite);
+static int codificar_rle(const unsigned char* datos, size_t n, size_t tamano, bloque* b);
+static int decodificar_rle(const unsigned char* datos, size_t tamano, unsigned char* destino, size_t n);
+static int decodificar_sin_tabla(int tipo, const unsigned char* datos, size_t tamano, unsigned char* destino,
+                                 size_t n);
+static uint64_t log2_fijo(uint64_t x);
+static uint64_t costo_parte(const uint64_t* frecuencias, int max_bits, int exacto);
+static size_t grano_division(const huffman_opciones* op);
+static int dividir_bloques(const unsigned char* datos, size_t n, const huffman_opciones* op, size_t cortes[],
+                           int lugar);
+static int codificar_bloque(int tipo, const unsigned char longitudes[], const unsigned char* datos, size_t n,
+                            bloque* b);
+static int escribir_bloque(FILE* out, const bloque* b);
+static int agregar_indice(indice* ix, uint64_t bytes, uint64_t original);
+static int escribir_indice(FILE* out, const indice* ix);
+static void dividir_region(void* arg);
+static void analizar_bloque(void* arg);
+static void comprimir_bloque(void* arg);
+static int comprimir_bloques(const unsigned char* datos, size_t n, FILE* in, FILE* out,
+                             const huffman_opciones* op);
+static int descomprimir_bloques(FILE* in, FILE* out);
+static int leer_varint_memoria(const unsigned char* p, size_t n, size_t* pos, uint64_t* valor);
+static void descomprimir_bloque(void* arg);
+static int descomprimir_bloques_hilos(const char* entrada, FILE* out, int hilos);
+static int comprimir_adaptativo(FILE* in, FILE* out);
+static int descomprimir_adaptativo(FILE* in, FILE* out);
+
+/*====================================================
+     Implementacion de funciones publicas
+  ====================================================*/
+
+/** Agus
+ * Prints the frequency of ASCII characters stored in an array.
+ *
+ * @param freq Pointer to an array of size 256 where each index represents an ASCII value
+ *             and the value at that index is the frequency of that character.
+ */
+ void print_frequency(const uint64_t* freq) {
+    int i;
+
+    if (!freq) {
+        fprintf(stderr, "Error: Null frequency array.\n");
+        return;
+    }
+
+    for (i = 0; i < NUM_CHARS; i++) {
+        if (freq[i] > 0) {
+            if (i >= 32 && i < 127)
+                printf("Character '%c' (ASCII %d): %llu times\n", i, i, (unsigned long long) freq[i]);
+            else
+                printf("ASCII %d: %llu times\n", i, (unsigned long long) freq[i]);
+        }
+    }
+}
+
+/*
+  Llena op con los valores por defecto.
+*/
+void huffman_opciones_defecto(huffman_opciones* op) {
+    op->max_bits = HUFFMAN_MAX_BITS_DEFECTO;
+    op->hilos = HUFFMAN_HILOS_DEFECTO;
+    op->tamano_bloque = HUFFMAN_BLOQUE_DEFECTO;
+    op->adaptativo = 0;
+    op->nivel = HUFFMAN_NIVEL_DEFECTO;
+}
+
+/*
+  Comprime archivo entrada y lo escriba a archivo salida.
+  
+  Retorna 0 si no hay errores.
+*/
+int comprimir(char* entrada, char* salida) {
+    huffman_opciones op;
+    huffman_opciones_defecto(&op);
+    return comprimir_opciones(entrada, salida, &op);
+}
+
+/*
+  Igual que comprimir() pero con las opciones dadas.
+*/
+int comprimir_opciones(char* entrada, char* salida, const huffman_opciones* op) {
+    
+    /* 256 es el numero de caracteres ASCII.
+       Asi podemos utilizar un unsigned char como indice.
+     */
+    uint64_t frecuencias[NUM_CHARS]; 
+    unsigned char longitudes[NUM_CHARS];
+    unsigned char varint[10];
+    uint64_t codigos;
+    size_t n;
+    Mapa mapa;
+    FILE* out;
+    int resultado;
+
+    if (!op || op->max_bits < 1 || op->max_bits > MAX_BITS) {
+        fprintf(stderr, "Error: max_bits must be between 1 and %d.\n", MAX_BITS);
+        return -1;
+    }
+    if (op->hilos < 1) {
+        fprintf(stderr, "Error: the number of threads must be at least 1.\n");
+        return -1;
+    }
+    if (op->tamano_bloque > HUFFMAN_BLOQUE_MAXIMO) {
+        fprintf(stderr, "Error: the block size must be at most %d bytes.\n", HUFFMAN_BLOQUE_MAXIMO);
+        return -1;
+    }
+    if (op->nivel < 1 || op->nivel > HUFFMAN_NIVEL_MAXIMO) {
+        fprintf(stderr, "Error: the compression level must be between 1 and %d.\n", HUFFMAN_NIVEL_MAXIMO);
+        return -1;
+    }
+
+    /* Adaptativo: una sola pasada, igual para archivos y la entrada estandar */
+    if (op->adaptativo) {
+        FILE* in = abrir_archivo(entrada, "rb");
+        CONFIRM_TRUE(in, -1);
+        out = abrir_archivo(salida, "wb");
+        if (!out) {
+            cerrar_archivo(in);
+            return -1;
+        }
+        resultado = comprimir_adaptativo(in, out);
+        cerrar_archivo(in);
+        if (0 != cerrar_archivo(out)) {
+            resultado = -1;
+        }
+        CONFIRM_TRUE(0 == resultado, -1);
+        return 0;
+    }
+
+    /* La entrada estandar no se puede recorrer dos veces: se comprime por
+       bloques a medida que llega, sin conocer el tamano total */
+    if (0 == strcmp(entrada, ARCHIVO_ESTANDAR)) {
+        huffman_opciones flujo = *op;
+        if (flujo.tamano_bloque == 0) {
+            flujo.tamano_bloque = HUFFMAN_BLOQUE_DEFECTO;
+        }
+        out = abrir_archivo(salida, "wb");
+        CONFIRM_TRUE(out, -1);
+        resultado = comprimir_bloques(NULL, 0, abrir_archivo(entrada, "rb"), out, &flujo);
+        if (0 != cerrar_archivo(out)) {
+            resultado = -1;
+        }
+        CONFIRM_TRUE(0 == resultado, -1);
+        return 0;
+    }
+
+    /* El archivo se abre una sola vez y los dos recorridos leen la misma memoria */
+    mapa = mapa_abrir(entrada);
+    CONFIRM_TRUE(mapa, -1);
+    out = abrir_archivo(salida, "wb");
+    if (!out) {
+        mapa_cerrar(mapa);
+        return -1;
+    }
+
+    if (op->tamano_bloque > 0) {
+        /* Por bloques, cada uno con su tabla */
+        resultado = comprimir_bloques(mapa_datos(mapa), mapa_tamano(mapa), NULL, out, op);
+    } else {
+        /* Primer recorrido - calcular frecuencias */
+        calcular_frecuencias(frecuencias, mapa_datos(mapa), mapa_tamano(mapa), op->hilos);
+
+        /* Longitud del codigo de cada caracter, sin armar el arbol */
+        calcular_longitudes(frecuencias, longitudes, op->max_bits);
+
+        /* Segundo recorrido - Codificar archivo */
+        n = mapa_tamano(mapa);
+        codigos = bytes_codigos(frecuencias, longitudes, 1);
+        if (codigos == UINT64_MAX || codigos + 1 + poner_varint(varint, n) > bytes_crudo(n)) {
+            /* Con la cabecera y la tabla ocupa mas que guardarlo (datos ya
+               comprimidos o aleatorios): por bloques, que se guardan sin
+               comprimir si codificarlos no los achica */
+            huffman_opciones bloques = *op;
+            bloques.tamano_bloque = HUFFMAN_BLOQUE_DEFECTO;
+            resultado = comprimir_bloques(mapa_datos(mapa), n, NULL, out, &bloques);
+        } else if (op->hilos > 1) {
+            resultado = codificar_hilos(longitudes, mapa_datos(mapa), n, out, op->hilos);
+        } else {
+            resultado = codificar(longitudes, mapa_datos(mapa), n, out);
+        }
+    }
+    if (0 != cerrar_archivo(out)) {
+        resultado = -1;
+    }
+    mapa_cerrar(mapa);
+    CONFIRM_TRUE(0 == resultado, -1);
+    
+    return 0;
+}
+
+
+/*
+  Descomprime archivo entrada y lo escriba a archivo salida.
+  
+  Retorna 0 si no hay errores.
+*/
+int descomprimir(char* entrada, char* salida) {
+    huffman_opciones op;
+    huffman_opciones_defecto(&op);
+    return descomprimir_opciones(entrada, salida, &op);
+}
+
+/*
+  Igual que descomprimir() pero con las opciones dadas.
+*/
+int descomprimir_opciones(char* entrada, char* salida, const huffman_opciones* op) {
+
+    FILE* in = NULL;
+    FILE* out = NULL;
+    unsigned char primero;
+    int formato;
+    int resultado;
+        
+    /* Abrir archivo de entrada y ver en que formato esta. El byte se lee
+       sin stdio, que de una tuberia se quedaria con lo que sigue y
+       descomprimir_adaptativo() lee el descriptor */
+    in = abrir_archivo(entrada, "rb");
+    CONFIRM_TRUE(in, -1);
+    CONFIRM_GOTO(1 == LeerDisponible(in, &primero, 1), error);
+    formato = primero;
+    CONFIRM_GOTO(formato == FORMATO_SIMPLE || formato == FORMATO_BLOQUES || formato == FORMATO_ADAPTATIVO, error);
+
+    /* Abrir archivo de salida (lectura y escritura, para poder mapearlo) */
+    out = abrir_archivo(salida, "w+b");
+    CONFIRM_GOTO(out, error);
+    
+    if (formato == FORMATO_SIMPLE) {
+        resultado = descomprimir_simple(in, out);
+    } else if (formato == FORMATO_ADAPTATIVO) {
+        resultado = descomprimir_adaptativo(in, out);
+    } else {
+        /* En paralelo si el archivo tiene indice y la salida se puede
+           mapear; si no (resultado 1), bloque por bloque. La entrada
+           estandar solo se puede leer en orden */
+        resultado = 1;
+        if (op && op->hilos > 1 && 0 != strcmp(entrada, ARCHIVO_ESTANDAR)) {
+            resultado = descomprimir_bloques_hilos(entrada, out, op->hilos);
+        }
+        if (resultado == 1) {
+            resultado = descomprimir_bloques(in, out);
+        }
+    }
+    
+    cerrar_archivo(in);
+    if (0 != cerrar_archivo(out)) {
+        resultado = -1;
+    }
+    /* No dejar un archivo a medias, que con un tamano danado puede ser
+       enorme */
+    if (0 != resultado && 0 != strcmp(salida, ARCHIVO_ESTANDAR)) {
+        remove(salida);
+    }
+    CONFIRM_TRUE(0 == resultado, -1);
+    return 0;
+
+error:
+    cerrar_archivo(in);
+    return -1;
+}
+
+/*====================================================
+     Funciones privadas
+  ====================================================*/
+
+
+/** Agus
+ * Counts the frequency of each ASCII character in the input,
+ * storing the result in the provided array.
+ *
+ * The counting is done by histograma_contar(), which spreads consecutive
+ * bytes over several tables so that runs of the same character do not
+ * stall on a single counter. Counters are 64 bits wide, so inputs with
+ * more than 2^31 copies of a byte are fine.
+ *
+ * With more than one thread the input is split into chunks that are
+ * counted concurrently into private tables and merged at the end.
+ *
+ * @param frecuencias Pointer to an array of size 256 where each index represents an ASCII value
+ *                    and the value at that index is the frequency of that character.
+ * @param datos The input contents.
+ * @param n Number of bytes in datos.
+ * @param hilos Number of threads to count with.
+ */
+static void calcular_frecuencias(uint64_t* frecuencias, const unsigned char* datos, size_t n, int hilos) {
+    memset(frecuencias, 0, NUM_CHARS * sizeof(uint64_t));
+    if (hilos > 1) {
+        histograma_contar_hilos(datos, n, hilos, frecuencias);
+    } else {
+        histograma_contar(datos, n, frecuencias);
+    }
+
+    //print_frequency(frecuencias); // Just for debuging
+}
+
+/* Compares two sort keys for qsort() */
+static int comparar_claves(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*) a;
+    uint64_t y = *(const uint64_t*) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Sorts the characters that appear in the input by frequency, ascending,
+ * breaking ties by character value.
+ *
+ * Frequency and character are packed into a single 64 bit key
+ * (frequency << 8 | character), so one qsort() of at most NUM_CHARS
+ * integers does all the work.
+ *
+ * @param frecuencias Frequency of every character.
+ * @param pesos       Where the sorted frequencies are stored.
+ * @param simbolos    Where the characters are stored, in the same order.
+ * @return The number of characters with a frequency greater than 0.
+ */
+static int ordenar_simbolos(const uint64_t* frecuencias, uint64_t pesos[], unsigned char simbolos[]) {
+    uint64_t claves[NUM_CHARS];
+    int n = 0;
+    int i;
+
+    for (i = 0; i < NUM_CHARS; i++) {
+        if (frecuencias[i] > 0) {
+            claves[n++] = (frecuencias[i] << 8) | (uint64_t) i;
+        }
+    }
+    qsort(claves, n, sizeof(uint64_t), comparar_claves);
+    for (i = 0; i < n; i++) {
+        pesos[i] = claves[i] >> 8;
+        simbolos[i] = (unsigned char) (claves[i] & 0xFF);
+    }
+    return n;
+}
+
+/**
+ * Computes the Huffman code length of every character without building a tree.
+ *
+ * After sorting the frequencies, the lengths are computed in place with the
+ * method of Moffat and Katajainen ("In-place calculation of minimum-redundancy
+ * codes", 1995), which only needs the sorted array and three linear passes:
+ *
+ *   1. Left to right, the array works as the two queues of the classic
+ *      linear Huffman construction: the leaves not used yet (from 'hoja' on)
+ *      and the internal nodes already built (from 'raiz' to 'siguiente').
+ *      Every internal node takes the weight of its two lightest candidates,
+ *      and a consumed internal node is overwritten with the index of its parent.
+ *   2. Right to left, parent indices become internal node depths.
+ *   3. Right to left, the number of internal nodes on every level gives how
+ *      many leaves are left on the next one, which is their code length.
+ *
+ * No memory is allocated. A lone character gets a 1 bit code, otherwise the
+ * decoder could never consume anything for it. Codes longer than max_bits
+ * are then fixed by limitar_longitudes().
+ *
+ * @param frecuencias Frequency of every character.
+ * @param longitudes  Array of NUM_CHARS where the lengths are stored (0 for unused characters).
+ * @param max_bits    Longest code length allowed.
+ */
+static void calcular_longitudes(const uint64_t* frecuencias, unsigned char longitudes[], int max_bits) {
+    uint64_t pesos[NUM_CHARS];
+    uint64_t A[NUM_CHARS];
+    unsigned char simbolos[NUM_CHARS];
+    int n;
+    int raiz, hoja, siguiente;
+    int disponibles, usados, profundidad;
+    int maxima = 0;
+    int i;
+
+    memset(longitudes, 0, NUM_CHARS);
+    n = ordenar_simbolos(frecuencias, pesos, simbolos);
+    if (n == 0) {
+        return;
+    }
+    if (n == 1) {
+        longitudes[simbolos[0]] = 1;
+        return;
+    }
+    memcpy(A, pesos, n * sizeof(uint64_t));
+
+    /* Primera pasada: pesos de los nodos internos e indices de sus padres */
+    A[0] += A[1];
+    raiz = 0;
+    hoja = 2;
+    for (siguiente = 1; siguiente < n - 1; siguiente++) {
+        if (hoja >= n || A[raiz] < A[hoja]) {
+            A[siguiente] = A[raiz];
+            A[raiz++] = (uint64_t) siguiente;
+        } else {
+            A[siguiente] = A[hoja++];
+        }
+        if (hoja >= n || (raiz < siguiente && A[raiz] < A[hoja])) {
+            A[siguiente] += A[raiz];
+            A[raiz++] = (uint64_t) siguiente;
+        } else {
+            A[siguiente] += A[hoja++];
+        }
+    }
+
+    /* Segunda pasada: profundidad de los nodos internos */
+    A[n - 2] = 0;
+    for (i = n - 3; i >= 0; i--) {
+        A[i] = A[A[i]] + 1;
+    }
+
+    /* Tercera pasada: profundidad de las hojas */
+    disponibles = 1;
+    usados = 0;
+    profundidad = 0;
+    raiz = n - 2;
+    siguiente = n - 1;
+    while (disponibles > 0) {
+        while (raiz >= 0 && A[raiz] == (uint64_t) profundidad) {
+            usados++;
+            raiz--;
+        }
+        while (disponibles > usados) {
+            A[siguiente--] = (uint64_t) profundidad;
+            disponibles--;
+        }
+        disponibles = 2 * usados;
+        profundidad++;
+        usados = 0;
+    }
+
+    for (i = 0; i < n; i++) {
+        longitudes[simbolos[i]] = (unsigned char) A[i];
+        if ((int) A[i] > maxima) {
+            maxima = (int) A[i];
+        }
+    }
+    if (maxima > max_bits) {
+        limitar_longitudes(pesos, simbolos, n, longitudes, max_bits);
+    }
+}
+
+/**
+ * Makes sure no code is longer than max_bits.
+ *
+ * Called when the Huffman code lengths exceed the limit: they are recomputed
+ * with the package-merge algorithm, which gives the optimal code among the
+ * ones limited to max_bits:
+ *
+ *   - list 1 holds the characters sorted by frequency.
+ *   - list j+1 is list j taken in pairs ("packages", whose weight is the
+ *     sum of both) merged with the characters, again sorted by weight.
+ *   - the 2n-2 lightest items of list max_bits are chosen. Every time a
+ *     character is chosen, directly or inside a package, its code gets
+ *     one bit longer.
+ *
+ * Only whether each item is a character or a package needs to be kept per
+ * list: characters and packages appear in order of weight, so the first m
+ * items of a list are always its lightest characters plus its first
+ * packages, and those packages are the first items of the previous list.
+ *
+ * If 2^max_bits is smaller than the number of characters no prefix code
+ * fits, and the smallest limit that does is used instead.
+ *
+ * @param hojas      Frequencies of the characters, sorted ascending.
+ * @param simbolos   The characters, in the same order.
+ * @param n          Number of characters (at least 2).
+ * @param longitudes Code lengths of every character, updated in place.
+ * @param max_bits   Longest code length allowed.
+ */
+static void limitar_longitudes(const uint64_t hojas[], const unsigned char simbolos[], int n,
+                               unsigned char longitudes[], int max_bits) {
+    uint64_t lista[2 * NUM_CHARS];
+    uint64_t anterior[2 * NUM_CHARS];
+    unsigned char es_hoja[MAX_BITS][2 * NUM_CHARS];
+    int tamano_anterior;
+    int elegidos;
+    int i;
+    int j;
+
+    while ((1 << max_bits) < n) {
+        max_bits++;
+    }
+
+    /* Lista 1: solamente los caracteres */
+    for (i = 0; i < n; i++) {
+        anterior[i] = hojas[i];
+        es_hoja[0][i] = 1;
+    }
+    tamano_anterior = n;
+
+    /* Listas 2..max_bits: paquetes de la lista anterior mezclados con los caracteres */
+    for (j = 1; j < max_bits; j++) {
+        int paquetes = tamano_anterior / 2;
+        int h = 0;
+        int p = 0;
+        int t = 0;
+        while (h < n || p < paquetes) {
+            uint64_t paquete = (p < paquetes) ? anterior[2 * p] + anterior[2 * p + 1] : 0;
+            if (p >= paquetes || (h < n && hojas[h] <= paquete)) {
+                lista[t] = hojas[h++];
+                es_hoja[j][t++] = 1;
+            } else {
+                lista[t] = paquete;
+                es_hoja[j][t++] = 0;
+                p++;
+            }
+        }
+        memcpy(anterior, lista, t * sizeof(uint64_t));
+        tamano_anterior = t;
+    }
+
+    /* Contar cuantas veces se elige cada caracter, de la ultima lista a la primera */
+    for (i = 0; i < n; i++) {
+        longitudes[simbolos[i]] = 0;
+    }
+    elegidos = 2 * n - 2;
+    for (j = max_bits - 1; j >= 0; j--) {
+        int caracteres = 0;
+        int paquetes = 0;
+        for (i = 0; i < elegidos; i++) {
+            if (es_hoja[j][i]) {
+                longitudes[simbolos[caracteres++]]++;
+            } else {
+                paquetes++;
+            }
+        }
+        elegidos = 2 * paquetes;
+    }
+}
+
+/**
+ * Assigns canonical Huffman codes from the code lengths.
+ *
+ * Codes of the same length are consecutive numbers given in character
+ * order, and the first code of length L+1 is (last code of length L + 1) * 2.
+ * This way the lengths alone are enough for the decoder to rebuild the
+ * same codes. Every code is stored with its first bit as the most
+ * significant one, ready for PutBits().
+ *
+ * @param longitudes Array of NUM_CHARS lengths, 0 for unused characters.
+ * @param codigos    Array of NUM_CHARS where the codes are stored.
+ * @return 0 on success, -1 if a length is larger than MAX_BITS.
+ */
+static int crear_codigos(const unsigned char longitudes[], unsigned long codigos[]) {
+    int cantidad[MAX_BITS + 1];
+    unsigned long siguiente[MAX_BITS + 1];
+    unsigned long codigo = 0;
+    int i;
+
+    memset(cantidad, 0, sizeof(cantidad));
+    for (i = 0; i < NUM_CHARS; i++) {
+        if (longitudes[i] > MAX_BITS) {
+            return -1;
+        }
+        cantidad[longitudes[i]]++;
+    }
+    cantidad[0] = 0;
+
+    for (i = 1; i <= MAX_BITS; i++) {
+        codigo = (codigo + cantidad[i - 1]) << 1;
+        siguiente[i] = codigo;
+    }
+
+    for (i = 0; i < NUM_CHARS; i++) {
+        codigos[i] = longitudes[i] ? siguiente[longitudes[i]]++ : 0;
+    }
+    return 0;
+}
+
+/* Number of bits needed to write any value from 0 to maximo */
+static int bits_para(unsigned long maximo) {
+    int w = 0;
+    while (w < 32 && (maximo >> w) != 0) {
+        w++;
+    }
+    return w;
+}
+
+/**
+ * Writes the size of the original file at the start of the compressed file,
+ * so the decompressor knows how many characters to decode.
+ *
+ * Format: 7 bits at a time, least significant first, 8 bits per group:
+ * 1 bit that is 1 if more groups follow, then the 7 bits of the group.
+ * Files under 128 bytes take 8 bits, under 16 KB 16 bits, and so on.
+ *
+ * @param out    BitStream where the size is written.
+ * @param tamano Size of the original file in bytes.
+ */
+static void escribir_tamano(BitStream out, uint64_t tamano) {
+    while (tamano >= 0x80) {
+        PutBits(out, 0x80 | (unsigned long) (tamano & 0x7F), 8);
+        tamano >>= 7;
+    }
+    PutBits(out, (unsigned long) tamano, 8);
+}
+
+/* Counts how many characters have a code of each length. Leaves the
+   longest length in *maxima and returns how many characters have a code */
+static int contar_longitudes(const unsigned char longitudes[], int cantidad[], int* maxima) {
+    int n = 0;
+    int i;
+
+    memset(cantidad, 0, (MAX_BITS + 1) * sizeof(int));
+    *maxima = 0;
+    for (i = 0; i < NUM_CHARS; i++) {
+        if (longitudes[i] > 0) {
+            cantidad[longitudes[i]]++;
+            n++;
+        }
+        if (longitudes[i] > *maxima) {
+            *maxima = longitudes[i];
+        }
+    }
+    return n;
+}
+
+/* Size in bits of the sparse list of escribir_longitudes() */
+static int bits_lista(const int cantidad[], int n, int maxima) {
+    int bits = 8 * n;
+    int restantes = n;
+    int L;
+
+    for (L = 1; L < maxima; L++) {
+        bits += bits_para(L < 31 && (1 << L) < restantes ? (1 << L) : restantes);
+        restantes -= cantidad[L];
+    }
+    return bits;
+}
+
+/* Size in bits of what escribir_longitudes() writes */
+static int tamano_longitudes(const unsigned char longitudes[]) {
+    int cantidad[MAX_BITS + 1];
+    int maxima;
+    int n = contar_longitudes(longitudes, cantidad, &maxima);
+    int lista;
+    int densa;
+
+    if (n == 0) {
+        return 9;
+    }
+    lista = bits_lista(cantidad, n, maxima);
+    densa = NUM_CHARS * bits_para(maxima);
+    return 9 + 5 + 1 + (lista < densa ? lista : densa);
+}
+
+/**
+ * Writes the code length of every character, after the size of the file.
+ *
+ * Format:
+ *   - 9 bits: n, number of characters with a code (0..256).
+ *   - if n > 0:
+ *     - 5 bits: M-1, where M is the longest code length.
+ *     - 1 bit:  0 if the list is sparse, 1 if it is dense.
+ *     - sparse: for every length L = 1..M-1, how many characters have a code
+ *               of length L (the ones of length M are the rest), using as
+ *               few bits as the largest possible count needs. Then the n
+ *               characters, 8 bits each, sorted by length and then by value,
+ *               which is the order canonical codes are given in.
+ *     - dense:  NUM_CHARS lengths of bits_para(M) bits, 0 for unused characters.
+ *
+ * The sparse list wins for text files with few distinct characters, the
+ * dense one for binary files that use most of them.
+ *
+ * @param out        BitStream where the header is written.
+ * @param longitudes Array of NUM_CHARS lengths, 0 for unused characters.
+ */
+static void escribir_longitudes(BitStream out, const unsigned char longitudes[]) {
+    int cantidad[MAX_BITS + 1];
+    int n;
+    int maxima;
+    int restantes;
+    int w;
+    int i;
+    int L;
+
+    n = contar_longitudes(longitudes, cantidad, &maxima);
+
+    PutBits(out, n, 9);
+    if (n == 0) {
+        return;
+    }
+    PutBits(out, maxima - 1, 5);
+
+    /* Se elige la representacion mas corta */
+    w = bits_para(maxima);
+    if (bits_lista(cantidad, n, maxima) < NUM_CHARS * w) {
+        PutBits(out, 0, 1);
+        restantes = n;
+        for (L = 1; L < maxima; L++) {
+            PutBits(out, cantidad[L], bits_para(L < 31 && (1 << L) < restantes ? (1 << L) : restantes));
+            restantes -= cantidad[L];
+        }
+        for (L = 1; L <= maxima; L++) {
+            for (i = 0; i < NUM_CHARS; i++) {
+                if (longitudes[i] == L) {
+                    PutBits(out, i, 8);
+                }
+            }
+        }
+    } else {
+        PutBits(out, 1, 1);
+        for (i = 0; i < NUM_CHARS; i++) {
+            PutBits(out, longitudes[i], w);
+        }
+    }
+}
+
+/* Writes the encoded text.
+   For each character in the input, write its corresponding
+   code with a single PutBits() call. */
+static void codificar_datos(BitStream out, const unsigned long codigos[], const unsigned char longitudes[],
+                            const unsigned char* datos, size_t n) {
+    size_t i;
+    for (i = 0; i < n; i++) {
+        PutBits(out, codigos[datos[i]], longitudes[datos[i]]);
+    }
+}
+
+/*
+  Abre el archivo nombre con fopen(), o si es ARCHIVO_ESTANDAR devuelve
+  stdin o stdout (segun modo), en modo binario.
+*/
+static FILE* abrir_archivo(const char* nombre, const char* modo) {
+    FILE* f;
+
+    if (0 == strcmp(nombre, ARCHIVO_ESTANDAR)) {
+        f = modo[0] == 'r' ? stdin : stdout;
+#ifdef _WIN32
+        _setmode(_fileno(f), _O_BINARY);
+#endif
+        return f;
+    }
+    f = fopen(nombre, modo);
+    if (!f) {
+        perror("Error opening file");
+    }
+    return f;
+}
+
+/*
+  Cierra un archivo de abrir_archivo(); stdin y stdout quedan abiertos
+  y solo se vacia stdout.
+  
+  Retorna 0 si no hay errores.
+*/
+static int cerrar_archivo(FILE* f) {
+    if (f == stdin) {
+        return 0;
+    }
+    if (f == stdout) {
+        return fflush(f);
+    }
+    return fclose(f);
+}
+
+/* Agus
+   Encodes the input using the Huffman code lengths and writes the result to the output file.
+   
+   Parameters:
+     longitudes - Code length of every character (0 if it does not appear).
+     datos      - The input contents.
+     n          - Number of bytes in datos.
+     salida     - Open output file where the encoded data will be written; it is
+                  flushed but not closed.
+   
+   Returns:
+     0 on success, or a nonzero value if an error occurs.
+   
+   The function performs the following:
+     1. Builds the canonical code of every character from its length.
+     2. Wraps the output file in a BitStream.
+     3. Writes the format, the input size and the code lengths as the header of the output file.
+     4. Goes through the input character by character and for each character, writes its 
+        corresponding code to the output file with a single PutBits() call.
+     5. Closes the BitStream, which flushes the output file.
+*/
+static int codificar(const unsigned char longitudes[], const unsigned char* datos, size_t n, FILE* salida) {
+    BitStream out = NULL;
+    unsigned long codigos[NUM_CHARS];
+
+    if (crear_codigos(longitudes, codigos) != 0) {
+        fprintf(stderr, "Error: Huffman code longer than %d bits.\n", MAX_BITS);
+        return -1;
+    }
+    
+    // Wrap the output file in a BitStream for writing
+    out = OpenBitStreamFile(salida, "w");
+    if (out == NULL) {
+        return -1;
+    }
+    
+    PutBits(out, FORMATO_SIMPLE, 8);
+    escribir_tamano(out, (uint64_t) n);
+    escribir_longitudes(out, longitudes);
+    
+    codificar_datos(out, codigos, longitudes, datos, n);
+    
+    // Clean up: close BitStream output (the file stays open)
+    return CloseBitStream(out);
+}
+
+/* Tarea del Pool: cuantos bits ocupan los codigos de un tramo */
+static void medir_tramo(void* arg) {
+    trabajo_tramo* t = (trabajo_tramo*) arg;
+    uint64_t frecuencias[NUM_CHARS];
+    calcular_frecuencias(frecuencias, t->datos, t->n, 1);
+    t->bits = costo_codigos(frecuencias, t->longitudes);
+}
+
+/* Tarea del Pool: codificar un tramo en memoria, corrido desfase bits */
+static void codificar_tramo(void* arg) {
+    trabajo_tramo* t = (trabajo_tramo*) arg;
+    BitStream out = OpenBitStreamMemory(NULL, t->n / 2 + 8);
+
+    t->salida = NULL;
+    if (!out) {
+        return;
+    }
+    PutBits(out, 0, t->desfase);
+    codificar_datos(out, t->codigos, t->longitudes, t->datos, t->n);
+    t->salida = CloseBitStreamMemory(out, &t->tamano);
+}
+
+/*
+  Escribe en out un segmento de bits bits que empieza desfase bits
+  dentro de su primer byte (datos tiene ceros antes y despues). El
+  primer byte se junta con *pendiente, el ultimo byte incompleto del
+  segmento anterior, y si este tambien termina a mitad de un byte, ese
+  byte queda en *pendiente en vez de escribirse.
+  
+  Retorna 0 si no hay errores.
+*/
+static int escribir_segmento(FILE* out, unsigned char* datos, int desfase, uint64_t bits, unsigned char* pendiente) {
+    size_t completos = (size_t) ((desfase + bits) / 8);
+
+    if (bits == 0) {
+        return 0;
+    }
+    if (desfase > 0) {
+        datos[0] |= *pendiente;
+    }
+    if (completos > 0 && fwrite(datos, 1, completos, out) != completos) {
+        perror("Error writing file");
+        return -1;
+    }
+    if ((desfase + bits) % 8 != 0) {
+        *pendiente = datos[completos];
+    }
+    return 0;
+}
+
+/*
+  Igual que codificar() pero con hilos hilos, y el mismo resultado.
+  
+  Con la tabla ya armada, lo que ocupa cada tramo de TRAMO_CODIFICACION
+  bytes se sabe de su histograma, sin codificarlo. Por cada tanda de
+  tramos, primero se mide cada uno en paralelo, despues se suman en
+  orden para saber en que bit del archivo empieza cada uno, y por ultimo
+  se codifican en paralelo, cada uno ya corrido a su posicion dentro de
+  su primer byte. Al escribirlos en orden solo hay que juntar el byte
+  que comparten dos tramos vecinos.
+  
+  Retorna 0 si no hay errores.
+*/
+static int codificar_hilos(const unsigned char longitudes[], const unsigned char* datos, size_t n, FILE* out,
+                           int hilos) {
+    unsigned long codigos[NUM_CHARS];
+    unsigned char varint[10];
+    unsigned char pendiente = 0;
+    uint64_t posicion;
+    trabajo_tramo* trabajos = NULL;
+    int tanda = hilos * BLOQUES_POR_HILO;
+    unsigned char* cabecera = NULL;
+    size_t tamano_cabecera;
+    BitStream bs;
+    Pool pool = NULL;
+    size_t inicio = 0;
+    int resultado = -1;
+
+    if (crear_codigos(longitudes, codigos) != 0) {
+        fprintf(stderr, "Error: Huffman code longer than %d bits.\n", MAX_BITS);
+        return -1;
+    }
+
+    trabajos = (trabajo_tramo*) malloc(tanda * sizeof(trabajo_tramo));
+    pool = pool_crear(hilos);
+    CONFIRM_GOTO(trabajos && pool, fin);
+
+    /* La cabecera es el primer segmento */
+    bs = OpenBitStreamMemory(NULL, 64);
+    CONFIRM_GOTO(bs, fin);
+    PutBits(bs, FORMATO_SIMPLE, 8);
+    escribir_tamano(bs, (uint64_t) n);
+    escribir_longitudes(bs, longitudes);
+    cabecera = CloseBitStreamMemory(bs, &tamano_cabecera);
+    CONFIRM_GOTO(cabecera, fin);
+    posicion = 8 + 8 * (uint64_t) poner_varint(varint, (uint64_t) n) + tamano_longitudes(longitudes);
+    CONFIRM_GOTO(0 == escribir_segmento(out, cabecera, 0, posicion, &pendiente), fin);
+
+    while (inicio < n) {
+        int cantidad = 0;
+        int error = 0;
+        int k;
+
+        /* Medir la tanda en paralelo */
+        while (cantidad < tanda && inicio < n) {
+            trabajo_tramo* t = &trabajos[cantidad++];
+            t->datos = datos + inicio;
+            t->n = n - inicio < TRAMO_CODIFICACION ? n - inicio : TRAMO_CODIFICACION;
+            t->longitudes = longitudes;
+            t->codigos = codigos;
+            t->tarea.funcion = medir_tramo;
+            t->tarea.arg = t;
+            pool_agregar(pool, &t->tarea);
+            inicio += t->n;
+        }
+        pool_esperar(pool);
+
+        /* Posicion de cada tramo, y codificar en paralelo */
+        for (k = 0; k < cantidad; k++) {
+            trabajo_tramo* t = &trabajos[k];
+            t->desfase = (int) (posicion % 8);
+            posicion += t->bits;
+            t->tarea.funcion = codificar_tramo;
+            pool_agregar(pool, &t->tarea);
+        }
+
+        /* Escribir en orden cada tramo apenas termina */
+        for (k = 0; k < cantidad; k++) {
+            trabajo_tramo* t = &trabajos[k];
+            pool_esperar_tarea(pool, &t->tarea);
+            if (!error && (!t->salida || 0 != escribir_segmento(out, t->salida, t->desfase, t->bits, &pendiente))) {
+                error = 1;
+            }
+            free(t->salida);
+        }
+        CONFIRM_GOTO(!error, fin);
+    }
+
+    /* Ultimo byte incompleto y cantidad de bits validos en el, igual que
+       CloseBitStream() */
+    if (posicion % 8 != 0) {
+        CONFIRM_GOTO(fputc(pendiente, out) != EOF, fin);
+    }
+    CONFIRM_GOTO(fputc(posicion % 8 != 0 ? (int) (posicion % 8) : 8, out) != EOF, fin);
+    resultado = 0;
+
+fin:
+    pool_destruir(pool);
+    free(trabajos);
+    free(cabecera);
+    return resultado;
+}
+
+/**
+ * Reads the size written by escribir_tamano().
+ *
+ * @param bs     BitStream positioned after the format byte.
+ * @param tamano Where the size is stored.
+ * @return 0 on success, -1 if the size is not valid.
+ */
+static int leer_tamano(BitStream bs, uint64_t* tamano) {
+    unsigned long grupo;
+    int desplazamiento = 0;
+
+    *tamano = 0;
+    do {
+        if (desplazamiento > 63 || BitsDisponibles(bs) < 8) {
+            return -1;
+        }
+        grupo = PeekBits(bs, 8);
+        ConsumeBits(bs, 8);
+        *tamano |= (uint64_t) (grupo & 0x7F) << desplazamiento;
+        desplazamiento += 7;
+    } while (grupo & 0x80);
+    return 0;
+}
+
+/**
+ * Reads the code lengths written by escribir_longitudes().
+ *
+ * @param bs         BitStream positioned after the size of the file.
+ * @param longitudes Array of NUM_CHARS where the lengths are stored.
+ * @return 0 on success, -1 if the header is not valid.
+ */
+static int leer_longitudes(BitStream bs, unsigned char longitudes[]) {
+    int cantidad[MAX_BITS + 1];
+    int n;
+    int maxima;
+    int restantes;
+    int i;
+    int L;
+
+    memset(longitudes, 0, NUM_CHARS);
+    n = (int) PeekBits(bs, 9);
+    ConsumeBits(bs, 9);
+    if (n == 0) {
+        return 0;
+    }
+    if (n > NUM_CHARS) {
+        return -1;
+    }
+    maxima = (int) PeekBits(bs, 5) + 1;
+    ConsumeBits(bs, 5);
+
+    if (GetBit(bs) == 0) {
+        restantes = n;
+        for (L = 1; L < maxima; L++) {
+            int w = bits_para(L < 31 && (1 << L) < restantes ? (1 << L) : restantes);
+            cantidad[L] = (int) PeekBits(bs, w);
+            ConsumeBits(bs, w);
+            if (cantidad[L] > restantes) {
+                return -1;
+            }
+            restantes -= cantidad[L];
+        }
+        cantidad[maxima] = restantes;
+        for (L = 1; L <= maxima; L++) {
+            for (i = 0; i < cantidad[L]; i++) {
+                longitudes[GetByte(bs)] = (unsigned char) L;
+            }
+        }
+    } else {
+        int w = bits_para(maxima);
+        for (i = 0; i < NUM_CHARS; i++) {
+            longitudes[i] = (unsigned char) PeekBits(bs, w);
+            ConsumeBits(bs, w);
+            if (longitudes[i] > maxima) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Builds the flat Huffman tree of the canonical codes given by longitudes[].
+ *
+ * Every code is inserted from the root, creating the pair of children of a
+ * node the first time a code goes through it. At most NUM_CHARS codes of at
+ * most MAX_BITS bits, so this is cheap, and no memory is allocated.
+ *
+ * @param t          Tree to fill.
+ * @param longitudes Array of NUM_CHARS lengths, 0 for unused characters.
+ * @return 0 on success, -1 if the lengths do not form a valid prefix code.
+ */
+static int arbol_plano_crear(arbol_plano* t, const unsigned char longitudes[]) {
+    unsigned long codigos[NUM_CHARS];
+    int i;
+
+    if (crear_codigos(longitudes, codigos) != 0) {
+        return -1;
+    }
+
+    t->hijos[0] = -1;
+    t->simbolo[0] = 0;
+    t->nodos = 1;
+    for (i = 0; i < NUM_CHARS; i++) {
+        int nodo = 0;
+        int b;
+        if (longitudes[i] == 0) {
+            continue;
+        }
+        for (b = longitudes[i] - 1; b >= 0; b--) {
+            if (t->hijos[nodo] == 0) {
+                return -1; // Otro codigo es prefijo de este
+            }
+            if (t->hijos[nodo] < 0) {
+                if (t->nodos + 2 > MAX_NODOS) {
+                    return -1;
+                }
+                t->hijos[nodo] = (short) t->nodos;
+                t->hijos[t->nodos] = -1;
+                t->hijos[t->nodos + 1] = -1;
+                t->simbolo[t->nodos] = 0;
+                t->simbolo[t->nodos + 1] = 0;
+                t->nodos += 2;
+            }
+            nodo = t->hijos[nodo] + (int) ((codigos[i] >> b) & 0x1);
+        }
+        if (t->hijos[nodo] >= 0) {
+            return -1; // Codigo repetido, o prefijo de otro
+        }
+        t->hijos[nodo] = 0;
+        t->simbolo[nodo] = (unsigned char) i;
+    }
+    return 0;
+}
+
+/**
+ * Fills the decoding table from the flat tree.
+ *
+ * Every node at depth d <= TABLA_BITS that ends the walk (a leaf, an unused
+ * node, or any node at depth TABLA_BITS) owns the 2^(TABLA_BITS-d) entries
+ * that start with the d bits leading to it. Nodes are processed by index,
+ * which is breadth first, keeping the path to each node in camino[].
+ *
+ * @param t     Flat Huffman tree.
+ * @param tabla Table of TABLA_TAMANO entries.
+ */
+static void arbol_plano_tabla(const arbol_plano* t, entrada_tabla tabla[]) {
+    unsigned int camino[MAX_NODOS];
+    unsigned char profundidad[MAX_NODOS];
+    int i;
+
+    camino[0] = 0;
+    profundidad[0] = 0;
+    for (i = 0; i < t->nodos; i++) {
+        int d = profundidad[i];
+        if (t->hijos[i] > 0) {
+            int h = t->hijos[i];
+            camino[h] = camino[i] << 1;
+            camino[h + 1] = (camino[i] << 1) | 1;
+            profundidad[h] = profundidad[h + 1] = (unsigned char) (d + 1);
+        }
+        if (d > TABLA_BITS || (t->hijos[i] > 0 && d < TABLA_BITS)) {
+            continue;
+        }
+        {
+            unsigned int primero = camino[i] << (TABLA_BITS - d);
+            unsigned int cantidad = 1u << (TABLA_BITS - d);
+            unsigned int j;
+            entrada_tabla entrada;
+
+            entrada.nodo = (short) i;
+            entrada.simbolo = t->simbolo[i];
+            entrada.longitud = (t->hijos[i] == 0) ? (unsigned char) d : 0;
+            for (j = 0; j < cantidad; j++) {
+                tabla[primero + j] = entrada;
+            }
+        }
+    }
+}
+
+/**
+ * Builds everything the decoder needs for the canonical codes given by
+ * longitudes[], without any allocation: the flat tree and its table.
+ *
+ * @param longitudes Array of NUM_CHARS lengths, 0 for unused characters.
+ * @param d          Decoder to fill.
+ * @return 0 on success, -1 if the lengths do not form a valid code.
+ */
+static int crear_decodificador(const unsigned char longitudes[], decodificador* d) {
+    int i;
+
+    if (arbol_plano_crear(&d->arbol, longitudes) != 0) {
+        return -1;
+    }
+    d->maxima = 0;
+    for (i = 0; i < NUM_CHARS; i++) {
+        if (longitudes[i] > d->maxima) {
+            d->maxima = longitudes[i];
+        }
+    }
+    arbol_plano_tabla(&d->arbol, d->tabla);
+    return 0;
+}
+
+/* Decodifica el caracter cuyo codigo empieza en el bit mas significativo
+   de ventana (los siguientes 32 bits del archivo comprimido).
+
+   Los siguientes TABLA_BITS bits se buscan en una tabla que da
+   directamente el simbolo y la longitud de su codigo. Solamente los
+   codigos mas largos que TABLA_BITS siguen bit a bit por el arbol plano,
+   desde el nodo guardado en la tabla.
+
+   Retorna el caracter y deja en *longitud la longitud de su codigo, o
+   retorna -1 si los bits no corresponden a ningun codigo.
+*/
+static int decodificar_simbolo(const decodificador* d, unsigned long ventana, int* longitud) {
+    const short* hijos = d->arbol.hijos;
+    entrada_tabla entrada = d->tabla[(ventana >> (32 - TABLA_BITS)) & (TABLA_TAMANO - 1)];
+    int nodo;
+    int usados;
+
+    if (entrada.longitud > 0) {
+        *longitud = entrada.longitud;
+        return entrada.simbolo;
+    }
+
+    // Codigo largo: seguir por el arbol desde el nodo de la tabla
+    nodo = entrada.nodo;
+    usados = TABLA_BITS;
+    while (hijos[nodo] > 0) {
+        nodo = hijos[nodo] + (int) ((ventana >> (31 - usados)) & 0x1);
+        usados++;
+    }
+    if (hijos[nodo] < 0) {
+        return -1;
+    }
+    *longitud = usados;
+    return d->arbol.simbolo[nodo];
+}
+
+/* Esto se utiliza como parte de la descompresion (ver descomprimir())..
+   
+   Ahora decodifica n caracteres de in y los escribe en destino, que
+   tiene lugar para n bytes.
+
+   Como se sabe cuantos caracteres hay, no hace falta preguntar antes de
+   cada uno si quedan bits. De la ventana de VentanaBits() (mas de 56
+   bits salvo al final del archivo) se decodifican codigos mientras lo
+   que queda tenga lugar para uno de la longitud maxima, y se consumen
+   juntos. Solamente cuando quedan en el archivo menos bits que eso se
+   revisa codigo por codigo que alcancen.
+
+   Retorna 0 si no hay errores, -1 si in se termina antes o tiene bits
+   que no corresponden a ningun codigo.
+*/   
+static int decodificar(BitStream in, const decodificador* d, unsigned char* destino, size_t n) {
+    size_t i = 0;
+    int maxima;
+    
+    if (!in || !d || (!destino && n > 0)) return -1; // Entry verification
+    maxima = d->maxima;
+    if (maxima == 0) {
+        return n == 0 ? 0 : -1; // Sin codigos no hay nada que decodificar
+    }
+
+    /* Rapido: codigos que seguro estan enteros en la ventana */
+    while (i < n) {
+        uint64_t ventana;
+        int disponibles = VentanaBits(in, &ventana);
+        int usados = 0;
+
+        if (disponibles < maxima) {
+            break; // Fin del archivo: menos bits que el codigo mas largo
+        }
+        while (i < n && usados + maxima <= disponibles) {
+            int longitud;
+            int c = decodificar_simbolo(d, (unsigned long) (ventana >> 32), &longitud);
+            if (c < 0) {
+                return -1; // Bits que no corresponden a ningun codigo
+            }
+            destino[i++] = (unsigned char) c;
+            ventana <<= longitud;
+            usados += longitud;
+        }
+        ConsumeBits(in, usados);
+    }
+
+    /* Cuidadoso: cerca del final, revisando que cada codigo este entero */
+    while (i < n) {
+        int disponibles = BitsDisponibles(in);
+        int longitud;
+        int c = decodificar_simbolo(d, PeekBits(in, 32), &longitud);
+        if (c < 0 || longitud > disponibles) {
+            return -1; // Faltan caracteres o bits que no son de ningun codigo
+        }
+        destino[i++] = (unsigned char) c;
+        ConsumeBits(in, longitud);
+    }
+    return 0;
+}
+
+/* Igual que decodificar() pero para una salida que no se puede mapear:
+   decodifica de a SALIDA_BLOQUE caracteres en un buffer y lo escribe en
+   out con un solo fwrite() cada vez.
+
+   Retorna 0 si no hay errores.
+*/
+static int decodificar_con_buffer(BitStream in, const decodificador* d, FILE* out, uint64_t n) {
+    unsigned char* buffer = (unsigned char*) malloc(SALIDA_BLOQUE);
+    int resultado = 0;
+
+    CONFIRM_TRUE(buffer, -1);
+    while (n > 0 && resultado == 0) {
+        size_t cantidad = n < SALIDA_BLOQUE ? (size_t) n : SALIDA_BLOQUE;
+        resultado = decodificar(in, d, buffer, cantidad);
+        if (resultado == 0 && fwrite(buffer, 1, cantidad, out) != cantidad) {
+            perror("Error writing file");
+            resultado = -1;
+        }
+        n -= cantidad;
+    }
+    free(buffer);
+    return resultado;
+}
+
+/*
+  Descomprime el FORMATO_SIMPLE: in esta justo despues del byte de
+  formato y out recien creado.
+  
+  Retorna 0 si no hay errores.
+*/
+static int descomprimir_simple(FILE* in, FILE* out) {
+
+    BitStream bs = 0;
+    Mapa mapa = NULL;
+    unsigned char longitudes[NUM_CHARS];
+    decodificador* d = NULL;
+    uint64_t tamano;
+    int64_t restante = mapa_restante(in);
+    int minima = MAX_BITS + 1;
+    int resultado;
+    int i;
+        
+    bs = OpenBitStreamFile(in, "r");
+    CONFIRM_TRUE(bs, -1);
+    
+    /* Leer el tamano original y las longitudes de los codigos, y armar las tablas */
+    d = (decodificador*) malloc(sizeof(decodificador));
+    CONFIRM_GOTO(d, error);
+    CONFIRM_GOTO(0 == leer_tamano(bs, &tamano), error);
+    CONFIRM_GOTO(0 == leer_longitudes(bs, longitudes), error);
+    CONFIRM_GOTO(0 == crear_decodificador(longitudes, d), error);
+
+    /* Cada byte ocupa al menos el codigo mas corto: un tamano que no entra
+       en lo que queda del archivo esta danado, y mapa_crear() lo creeria
+       y agrandaria la salida hasta ese tamano. De una tuberia no se sabe
+       lo que queda, pero se decodifica de a bloques y falla al terminarse */
+    for (i = 0; i < NUM_CHARS; i++) {
+        if (longitudes[i] > 0 && longitudes[i] < minima) {
+            minima = longitudes[i];
+        }
+    }
+    if (restante >= 0) {
+        CONFIRM_GOTO(tamano == 0 || (minima <= MAX_BITS && tamano <= 8 * (uint64_t) restante / minima), error);
+    }
+
+    /* Decodificar archivo: directamente en su memoria si se puede mapear
+       con su tamano final, si no de a bloques con fwrite() */
+    if (restante >= 0 && tamano <= (size_t) -1 && (mapa = mapa_crear(out, (size_t) tamano)) != NULL) {
+        resultado = decodificar(bs, d, mapa_destino(mapa), (size_t) tamano);
+        if (0 != mapa_cerrar(mapa)) {
+            resultado = -1;
+        }
+    } else {
+        resultado = decodificar_con_buffer(bs, d, out, tamano);
+    }
+    
+    CloseBitStream(bs);
+    free(d);
+    return resultado;
+
+error:
+    CloseBitStream(bs);
+    free(d);
+    return -1;
+}
+
+/*====================================================
+     Formato por bloques
+  ====================================================*/
+
+/*
+  Escribe valor en destino de a 7 bits, el grupo menos significativo
+  primero, con el bit mas alto de cada byte en 1 si siguen mas grupos
+  (igual que escribir_tamano(), pero alineado a bytes).
+  
+  Retorna cuantos bytes escribio (a lo sumo 10).
+*/
+static int poner_varint(unsigned char* destino, uint64_t valor) {
+    int n = 0;
+    while (valor >= 0x80) {
+        destino[n++] = (unsigned char) (0x80 | (valor & 0x7F));
+        valor >>= 7;
+    }
+    destino[n++] = (unsigned char) valor;
+    return n;
+}
+
+/*
+  Lee de in un valor escrito con poner_varint().
+  
+  Retorna 0 si no hay errores, -1 si se termina el archivo o el valor
+  no entra en 64 bits.
+*/
+static int leer_varint(FILE* in, uint64_t* valor) {
+    int c;
+    int desplazamiento = 0;
+
+    *valor = 0;
+    do {
+        c = fgetc(in);
+        if (c == EOF || desplazamiento > 63) {
+            return -1;
+        }
+        *valor |= (uint64_t) (c & 0x7F) << desplazamiento;
+        desplazamiento += 7;
+    } while (c & 0x80);
+    return 0;
+}
+
+/*
+  Cantidad de bits que ocupan los codigos de los caracteres contados en
+  frecuencias con las longitudes dadas, o UINT64_MAX si algun caracter
+  que aparece no tiene codigo.
+*/
+static uint64_t costo_codigos(const uint64_t* frecuencias, const unsigned char longitudes[]) {
+    uint64_t costo = 0;
+    int i;
+
+    for (i = 0; i < NUM_CHARS; i++) {
+        if (frecuencias[i] > 0) {
+            if (longitudes[i] == 0) {
+                return UINT64_MAX;
+            }
+            costo += frecuencias[i] * longitudes[i];
+        }
+    }
+    return costo;
+}
+
+/*
+  Decide si un bloque con estas frecuencias se codifica con la tabla
+  vigente (la del ultimo bloque que mando la suya) en vez de con su tabla
+  nueva: conviene si ocupa lo mismo o menos que la nueva mas lo que
+  ocupa escribirla.
+*/
+static int reusar_tabla(const uint64_t* frecuencias, const unsigned char nueva[], const unsigned char vigente[]) {
+    uint64_t con_vigente = costo_codigos(frecuencias, vigente);
+    uint64_t con_nueva = costo_codigos(frecuencias, nueva) + tamano_longitudes(nueva);
+    return con_vigente <= con_nueva;
+}
+
+/*
+  Bytes que ocupa un bloque con estas frecuencias codificado con las
+  longitudes dadas, mas la tabla si con_tabla. Si no es menos que el
+  bloque conviene guardarlo sin comprimir (BLOQUE_CRUDO): pasa con datos
+  ya comprimidos o aleatorios, y asi no se pierde tiempo codificandolos
+  ni decodificandolos.
+*/
+static uint64_t bytes_codigos(const uint64_t* frecuencias, const unsigned char longitudes[], int con_tabla) {
+    uint64_t bits = costo_codigos(frecuencias, longitudes);
+    if (bits == UINT64_MAX) {
+        return UINT64_MAX;
+    }
+    if (con_tabla) {
+        bits += tamano_longitudes(longitudes);
+    }
+    return (bits + 7) / 8;
+}
+
+/*
+  Bytes que ocupan a lo sumo n bytes en el FORMATO_BLOQUES si se guardan
+  sin comprimir, en bloques de HUFFMAN_BLOQUE_DEFECTO: lo que se compara
+  con el FORMATO_SIMPLE para saber si una sola tabla agranda el archivo.
+*/
+static uint64_t bytes_crudo(size_t n) {
+    unsigned char varint[10];
+    uint64_t bloques = ((uint64_t) n + HUFFMAN_BLOQUE_DEFECTO - 1) / HUFFMAN_BLOQUE_DEFECTO;
+    /* Cabecera de un bloque lleno: tipo, tamano original y guardado */
+    uint64_t cabecera = 1 + 2 * (uint64_t) poner_varint(varint, HUFFMAN_BLOQUE_DEFECTO);
+    /* Lo que ocupa en el indice */
+    uint64_t entrada = poner_varint(varint, HUFFMAN_BLOQUE_DEFECTO + cabecera)
+                     + poner_varint(varint, HUFFMAN_BLOQUE_DEFECTO);
+
+    return 1 + poner_varint(varint, (uint64_t) n + 1) + (uint64_t) n + bloques * (cabecera + entrada)
+         + 1 + poner_varint(varint, bloques) + INDICE_COLA;
+}
+
+/*
+  Bytes que ocupan los n bytes de datos con codificar_rle(), o algo mayor
+  que limite si ocupan mas que eso.
+  
+  Cada racha ocupa al menos 2 bytes, asi que primero se cuentan los
+  cambios de byte de a tramos de RLE_TRAMO, sin saltos, y se deja de
+  contar apenas el doble pasa limite (en un texto, enseguida). Solo si
+  no pasa se recorren las rachas para saber el tamano exacto.
+*/
+static uint64_t tamano_rle(const unsigned char* datos, size_t n, uint64_t limite) {
+    unsigned char varint[10];
+    uint64_t tamano = 0;
+    uint64_t cambios = 0;
+    size_t i = 1;
+
+    while (i < n) {
+        size_t fin = n - i < RLE_TRAMO ? n : i + RLE_TRAMO;
+        for (; i < fin; i++) {
+            cambios += datos[i] != datos[i - 1];
+        }
+        if (2 * (cambios + 1) > limite) {
+            return limite + 1;
+        }
+    }
+
+    i = 0;
+    while (i < n && tamano <= limite) {
+        size_t j = i + 1;
+        while (j < n && datos[j] == datos[i]) {
+            j++;
+        }
+        tamano += 1 + poner_varint(varint, (uint64_t) (j - i - 1));
+        i = j;
+    }
+    return tamano;
+}
+
+/*
+  Codifica los n bytes de datos como rachas de un mismo byte: por cada
+  una el byte y su largo menos 1 (con poner_varint()). tamano es lo que
+  ocupa, ya calculado con tamano_rle(). Deja el resultado en b, y
+  b->datos hay que liberarlo con free().
+  
+  Retorna 0 si no hay errores.
+*/
+static int codificar_rle(const unsigned char* datos, size_t n, size_t tamano, bloque* b) {
+    size_t i = 0;
+    size_t k = 0;
+
+    b->datos = (unsigned char*) malloc(tamano > 0 ? tamano : 1);
+    CONFIRM_TRUE(b->datos, -1);
+    while (i < n) {
+        size_t j = i + 1;
+        while (j < n && datos[j] == datos[i]) {
+            j++;
+        }
+        b->datos[k++] = datos[i];
+        k += poner_varint(b->datos + k, (uint64_t) (j - i - 1));
+        i = j;
+    }
+    b->tipo = BLOQUE_RLE;
+    b->original = n;
+    b->tamano = k;
+    return 0;
+}
+
+/*
+  Decodifica las rachas de codificar_rle() de los tamano bytes de datos
+  en los n bytes de destino, con memset().
+  
+  Retorna 0 si no hay errores (las rachas llenan exactamente destino).
+*/
+static int decodificar_rle(const unsigned char* datos, size_t tamano, unsigned char* destino, size_t n) {
+    size_t pos = 0;
+    size_t escritos = 0;
+
+    while (pos < tamano) {
+        unsigned char c = datos[pos++];
+        uint64_t largo;
+        CONFIRM_TRUE(0 == leer_varint_memoria(datos, tamano, &pos, &largo), -1);
+        CONFIRM_TRUE(largo < n - escritos, -1);
+        memset(destino + escritos, c, (size_t) largo + 1);
+        escritos += (size_t) largo + 1;
+    }
+    CONFIRM_TRUE(escritos == n, -1);
+    return 0;
+}
+
+/*
+  Decodifica un bloque que no usa tabla (BLOQUE_CRUDO, BLOQUE_UNICO o
+  BLOQUE_RLE) de los tamano bytes de datos en los n bytes de destino.
+  
+  Retorna 0 si no hay errores.
+*/
+static int decodificar_sin_tabla(int tipo, const unsigned char* datos, size_t tamano, unsigned char* destino,
+                                 size_t n) {
+    if (tipo == BLOQUE_CRUDO) {
+        CONFIRM_TRUE(tamano == n, -1);
+        memcpy(destino, datos, n);
+        return 0;
+    }
+    if (tipo == BLOQUE_UNICO) {
+        CONFIRM_TRUE(tamano == 1, -1);
+        memset(destino, datos[0], n);
+        return 0;
+    }
+    return decodificar_rle(datos, tamano, destino, n);
+}
+
+/*
+  Codifica los n bytes de datos en memoria con las longitudes dadas.
+  Si tipo es BLOQUE_HUFFMAN primero escribe la tabla. Deja el resultado
+  en b, y b->datos hay que liberarlo con free().
+  
+  Retorna 0 si no hay errores.
+*/
+static int codificar_bloque(int tipo, const unsigned char longitudes[], const unsigned char* datos, size_t n,
+                            bloque* b) {
+    unsigned long codigos[NUM_CHARS];
+    BitStream out;
+
+    if (crear_codigos(longitudes, codigos) != 0) {
+        fprintf(stderr, "Error: Huffman code longer than %d bits.\n", MAX_BITS);
+        return -1;
+    }
+
+    /* La mitad del bloque suele alcanzar; si no, el buffer crece solo */
+    out = OpenBitStreamMemory(NULL, n / 2 + MAX_TABLA);
+    CONFIRM_TRUE(out, -1);
+    if (tipo == BLOQUE_HUFFMAN) {
+        escribir_longitudes(out, longitudes);
+    }
+    codificar_datos(out, codigos, longitudes, datos, n);
+
+    b->tipo = tipo;
+    b->original = n;
+    b->datos = CloseBitStreamMemory(out, &b->tamano);
+    CONFIRM_TRUE(b->datos, -1);
+    return 0;
+}
+
+/*
+  Escribe el bloque b en out: el tipo (1 byte), el tamano original y el
+  tamano comprimido (con poner_varint()) y los bytes comprimidos.
+  
+  Retorna cuantos bytes escribio, o -1 si hay errores.
+*/
+static int escribir_bloque(FILE* out, const bloque* b) {
+    unsigned char cabecera[1 + 10 + 10];
+    int n = 0;
+
+    cabecera[n++] = (unsigned char) b->tipo;
+    n += poner_varint(cabecera + n, (uint64_t) b->original);
+    n += poner_varint(cabecera + n, (uint64_t) b->tamano);
+    if (fwrite(cabecera, 1, n, out) != (size_t) n
+        || fwrite(b->crudo ? b->crudo : b->datos, 1, b->tamano, out) != b->tamano) {
+        perror("Error writing file");
+        return -1;
+    }
+    return n + (int) b->tamano;
+}
+
+/*
+  Agrega al indice un bloque que ocupa bytes bytes en el archivo
+  comprimido y original bytes sin comprimir.
+  
+  Retorna 0 si no hay errores.
+*/
+static int agregar_indice(indice* ix, uint64_t bytes, uint64_t original) {
+    if (ix->tamano + 20 > ix->capacidad) {
+        size_t capacidad = ix->capacidad > 0 ? 2 * ix->capacidad : 256;
+        unsigned char* nuevo = (unsigned char*) realloc(ix->datos, capacidad);
+        CONFIRM_TRUE(nuevo, -1);
+        ix->datos = nuevo;
+        ix->capacidad = capacidad;
+    }
+    ix->tamano += poner_varint(ix->datos + ix->tamano, bytes);
+    ix->tamano += poner_varint(ix->datos + ix->tamano, original);
+    ix->bloques++;
+    return 0;
+}
+
+/*
+  Escribe el indice al final del archivo, despues de BLOQUE_FIN:
+  
+    - varint: cantidad de bloques
+    - para cada bloque, con poner_varint(): los bytes que ocupa con su
+      cabecera y su tamano original
+    - 4 bytes: largo de lo anterior
+    - 4 bytes: INDICE_MARCA
+  
+  Con esto se puede saber donde empieza cada bloque, y donde va en el
+  archivo descomprimido, sin leer los anteriores.
+  
+  Retorna 0 si no hay errores.
+*/
+static int escribir_indice(FILE* out, const indice* ix) {
+    unsigned char cabecera[10];
+    unsigned char cola[INDICE_COLA];
+    int n = poner_varint(cabecera, ix->bloques);
+    uint64_t largo = (uint64_t) n + ix->tamano;
+    int i;
+
+    CONFIRM_TRUE(largo <= 0xFFFFFFFFul, -1);
+    for (i = 0; i < 4; i++) {
+        cola[i] = (unsigned char) (largo >> (8 * i));
+        cola[4 + i] = (unsigned char) (INDICE_MARCA >> (8 * i));
+    }
+    /* Sin bloques datos puede ser NULL, y fwrite no lo acepta aunque el
+       largo sea 0 */
+    if (fwrite(cabecera, 1, n, out) != (size_t) n
+        || (ix->tamano > 0 && fwrite(ix->datos, 1, ix->tamano, out) != ix->tamano)
+        || fwrite(cola, 1, INDICE_COLA, out) != INDICE_COLA) {
+        perror("Error writing file");
+        return -1;
+    }
+    return 0;
+}
+
+/* log2(x) en 1/65536 de bit (x >= 1), con la parte entera exacta y la
+   fraccion de los 8 bits que siguen al mas significativo */
+static uint64_t log2_fijo(uint64_t x) {
+    int e = 0;
+    int k;
+
+    for (k = 32; k > 0; k >>= 1) {
+        if (x >> (e + k)) {
+            e += k;
+        }
+    }
+    x = e >= 8 ? x >> (e - 8) : x << (8 - e);
+    return ((uint64_t) e << FIJO_BITS) + log2_mantisa[x & 0xFF];
+}
+
+/*
+  Costo estimado en 1/65536 de bit de un bloque con estas frecuencias: su
+  entropia (lo que ocuparian los codigos ideales), la tabla con las
+  longitudes que les corresponderian y la cabecera del bloque. Nunca mas
+  que guardarlo sin comprimir, ni que un BLOQUE_UNICO.
+  
+  Si exacto, los codigos y la tabla son los que se escribirian, con
+  calcular_longitudes(): es mas preciso pero bastante mas lento.
+*/
+static uint64_t costo_parte(const uint64_t* frecuencias, int max_bits, int exacto) {
+    unsigned char longitudes[NUM_CHARS];
+    uint64_t total = 0;
+    uint64_t bits = 0;
+    uint64_t log2_total;
+    int distintos = 0;
+    int i;
+
+    for (i = 0; i < NUM_CHARS; i++) {
+        total += frecuencias[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    log2_total = log2_fijo(total);
+    for (i = 0; i < NUM_CHARS; i++) {
+        longitudes[i] = 0;
+        if (frecuencias[i] > 0) {
+            uint64_t largo = log2_total - log2_fijo(frecuencias[i]);
+            int redondeo = (int) ((largo + (1 << (FIJO_BITS - 1))) >> FIJO_BITS);
+            bits += frecuencias[i] * largo;
+            longitudes[i] = (unsigned char) (redondeo < 1 ? 1 : redondeo > max_bits ? max_bits : redondeo);
+            distintos++;
+        }
+    }
+    if (distintos == 1) {
+        return (uint64_t) (COSTO_CABECERA + 8) << FIJO_BITS;
+    }
+    if (exacto) {
+        calcular_longitudes(frecuencias, longitudes, max_bits);
+        bits = costo_codigos(frecuencias, longitudes) << FIJO_BITS;
+    }
+    bits += (uint64_t) tamano_longitudes(longitudes) << FIJO_BITS;
+    if (bits > (8 * total) << FIJO_BITS) {
+        bits = (8 * total) << FIJO_BITS;
+    }
+    return bits + ((uint64_t) COSTO_CABECERA << FIJO_BITS);
+}
+
+/* Tamano de las partes de dividir_bloques(): a lo sumo op->tamano_bloque
+   y en lo posible al menos GRANO_MINIMO */
+static size_t grano_division(const huffman_opciones* op) {
+    size_t grano = op->tamano_bloque / granos_por_bloque[op->nivel];
+    if (grano < GRANO_MINIMO) {
+        grano = op->tamano_bloque < GRANO_MINIMO ? op->tamano_bloque : GRANO_MINIMO;
+    }
+    return grano;
+}
+
+/*
+  Elige donde cortar los n bytes de datos en bloques de a lo sumo
+  op->tamano_bloque bytes, para los niveles de compresion mayores que 1.
+  
+  Los cortes posibles estan cada grano_division() bytes. Con el
+  histograma acumulado de las partes, el de cualquier tramo sale de una
+  resta, y la mejor division de los primeros j granos es la mejor de
+  los primeros i mas un bloque de i a j, con costo_parte() (exacto desde
+  NIVEL_EXACTO). Asi un corte queda donde cambia el contenido y vale la
+  pena pagar otra tabla, y partes parecidas quedan juntas en un bloque
+  mientras quepan en op->tamano_bloque.
+  
+  Deja en cortes[] donde termina cada bloque, en orden; tiene lugar para
+  lugar cortes.
+  Retorna cuantos bloques, o -1 si hay errores.
+*/
+static int dividir_bloques(const unsigned char* datos, size_t n, const huffman_opciones* op, size_t cortes[],
+                           int lugar) {
+    size_t grano = grano_division(op);
+    int maximo = (int) (op->tamano_bloque / grano);
+    int granos = (int) ((n + grano - 1) / grano);
+    uint64_t* acumulado = NULL;
+    uint64_t* costo = NULL;
+    int* desde = NULL;
+    uint64_t parte[NUM_CHARS];
+    int bloques = 0;
+    int cantidad = -1;
+    int i;
+    int j;
+    int k;
+
+    acumulado = (uint64_t*) malloc((size_t) (granos + 1) * NUM_CHARS * sizeof(uint64_t));
+    costo = (uint64_t*) malloc((size_t) (granos + 1) * sizeof(uint64_t));
+    desde = (int*) malloc((size_t) (granos + 1) * sizeof(int));
+    CONFIRM_GOTO(acumulado && costo && desde, fin);
+
+    memset(acumulado, 0, NUM_CHARS * sizeof(uint64_t));
+    for (j = 1; j <= granos; j++) {
+        size_t inicio = (size_t) (j - 1) * grano;
+        memcpy(acumulado + (size_t) j * NUM_CHARS, acumulado + (size_t) (j - 1) * NUM_CHARS,
+               NUM_CHARS * sizeof(uint64_t));
+        histograma_contar(datos + inicio, n - inicio < grano ? n - inicio : grano, acumulado + (size_t) j * NUM_CHARS);
+    }
+
+    costo[0] = 0;
+    for (j = 1; j <= granos; j++) {
+        costo[j] = UINT64_MAX;
+        for (i = j - 1; i >= 0 && i >= j - maximo; i--) {
+            uint64_t c;
+            for (k = 0; k < NUM_CHARS; k++) {
+                parte[k] = acumulado[(size_t) j * NUM_CHARS + k] - acumulado[(size_t) i * NUM_CHARS + k];
+            }
+            c = costo[i] + costo_parte(parte, op->max_bits, op->nivel >= NIVEL_EXACTO);
+            if (c < costo[j]) {
+                costo[j] = c;
+                desde[j] = i;
+            }
+        }
+    }
+
+    /* Los cortes, del ultimo al primero */
+    for (j = granos; j > 0; j = desde[j]) {
+        bloques++;
+    }
+    CONFIRM_GOTO(bloques <= lugar, fin);
+    cantidad = bloques;
+    k = cantidad;
+    for (j = granos; j > 0; j = desde[j]) {
+        cortes[--k] = (size_t) j * grano < n ? (size_t) j * grano : n;
+    }
+
+fin:
+    free(acumulado);
+    free(costo);
+    free(desde);
+    return cantidad;
+}
+
+/* Tarea del Pool: donde cortar una region */
+static void dividir_region(void* arg) {
+    trabajo_division* t = (trabajo_division*) arg;
+    t->cantidad = dividir_bloques(t->datos, t->n, t->op, t->cortes, t->lugar);
+}
+
+/* Tarea del Pool: frecuencias y longitudes de un bloque */
+static void analizar_bloque(void* arg) {
+    trabajo_bloque* t = (trabajo_bloque*) arg;
+    int i;
+
+    calcular_frecuencias(t->frecuencias, t->datos, t->n, 1);
+    calcular_longitudes(t->frecuencias, t->longitudes, t->max_bits);
+    t->distintos = 0;
+    for (i = 0; i < NUM_CHARS; i++) {
+        t->distintos += t->frecuencias[i] > 0;
+    }
+    /* Con RLE solo interesa si ocupa menos que con la tabla propia */
+    t->rle = tamano_rle(t->datos, t->n, bytes_codigos(t->frecuencias, t->longitudes, 1));
+}
+
+/* Tarea del Pool: codificar un bloque con la tabla ya elegida */
+static void comprimir_bloque(void* arg) {
+    trabajo_bloque* t = (trabajo_bloque*) arg;
+    t->b.datos = NULL;
+    t->b.crudo = NULL;
+    if (t->tipo == BLOQUE_CRUDO || t->tipo == BLOQUE_UNICO) {
+        /* El byte de un BLOQUE_UNICO es el primero del bloque */
+        t->b.tipo = t->tipo;
+        t->b.original = t->n;
+        t->b.crudo = t->datos;
+        t->b.tamano = t->tipo == BLOQUE_CRUDO ? t->n : 1;
+        t->error = 0;
+        return;
+    }
+    if (t->tipo == BLOQUE_RLE) {
+        t->error = codificar_rle(t->datos, t->n, (size_t) t->rle, &t->b);
+        return;
+    }
+    t->error = codificar_bloque(t->tipo, t->tabla, t->datos, t->n, &t->b);
+}
+
+/*
+  Comprime los n bytes de datos en out con el FORMATO_BLOQUES, o si in
+  no es NULL lo que se lee de in hasta el final:
+  
+    - 1 byte: FORMATO_BLOQUES
+    - varint: tamano original mas 1 (0 si no se conoce)
+    - los bloques de op->tamano_bloque bytes (el ultimo puede ser menor),
+      ver escribir_bloque(). Con op->nivel mayor que 1 son de a lo sumo
+      ese tamano y se cortan donde cambia el contenido (ver
+      dividir_bloques()). Un bloque BLOQUE_HUFFMAN empieza con su tabla
+      (igual que escribir_longitudes()) y uno BLOQUE_REUSA usa la tabla
+      del ultimo que mando una. Los codigos ocupan hasta el final del
+      ultimo byte del bloque, asi cada bloque empieza en un byte entero.
+      Los bloques que no usan tabla no cambian la vigente: un BLOQUE_UNICO
+      es un solo byte que se repite todo el bloque, un BLOQUE_RLE tiene
+      sus rachas (ver codificar_rle()) si ocupan menos que los codigos, y
+      un BLOQUE_CRUDO tiene los bytes tal cual si codificarlos no los
+      achica (ver bytes_codigos()).
+    - 1 byte: BLOQUE_FIN
+    - el indice de los bloques, ver escribir_indice()
+  
+  Cada bloque tiene su propia tabla, asi que se adapta a los cambios en
+  el contenido (un log seguido de texto, por ejemplo), y se puede
+  descomprimir sin los bloques anteriores salvo por la tabla reusada.
+  
+  Los bloques se comprimen de a tandas de op->hilos * BLOQUES_POR_HILO
+  en un Pool de op->hilos hilos: primero se analizan todos en paralelo,
+  despues se elige en orden la tabla de cada uno y por ultimo se
+  codifican en paralelo. Cada bloque se escribe apenas terminan el y
+  los anteriores, asi que la salida es la misma con cualquier cantidad
+  de hilos.
+  
+  Desde in se lee de a una tanda, asi que la memoria no depende del largo
+  de la entrada, y como el tamano original no se conoce hasta el final
+  la cabecera dice 0.
+  
+  Retorna 0 si no hay errores.
+*/
+static int comprimir_bloques(const unsigned char* datos, size_t n, FILE* in, FILE* out,
+                             const huffman_opciones* op) {
+    unsigned char cabecera[1 + 10];
+    unsigned char vigente[NUM_CHARS];
+    int hay_vigente = 0;
+    trabajo_bloque* trabajos = NULL;
+    indice ix = { NULL, 0, 0, 0 };
+    int tanda = op->hilos * BLOQUES_POR_HILO;
+    size_t capacidad = (size_t) tanda * op->tamano_bloque;
+    int bloques = tanda;
+    size_t region = (size_t) BLOQUES_POR_HILO * op->tamano_bloque;
+    int por_region = BLOQUES_POR_HILO;
+    trabajo_division* divisiones = NULL;
+    size_t* cortes = NULL;
+    unsigned char* buffer = NULL;
+    Pool pool = NULL;
+    size_t inicio = 0;
+    int resultado = -1;
+    int c = 0;
+
+    cabecera[c++] = FORMATO_BLOQUES;
+    c += poner_varint(cabecera + c, in ? 0 : (uint64_t) n + 1);
+    CONFIRM_TRUE(fwrite(cabecera, 1, c, out) == (size_t) c, -1);
+
+    /* Con division por costo una tanda puede tener hasta un bloque por
+       grano, y cada region se divide por separado. El grano no siempre
+       divide a la region: el ultimo, incompleto, tambien puede ser un
+       bloque */
+    if (op->nivel > 1) {
+        size_t grano = grano_division(op);
+        por_region = (int) ((region + grano - 1) / grano);
+        bloques = op->hilos * por_region;
+        divisiones = (trabajo_division*) malloc(op->hilos * sizeof(trabajo_division));
+        CONFIRM_GOTO(divisiones, fin);
+    }
+    trabajos = (trabajo_bloque*) malloc(bloques * sizeof(trabajo_bloque));
+    cortes = (size_t*) malloc(bloques * sizeof(size_t));
+    CONFIRM_GOTO(trabajos && cortes, fin);
+    pool = pool_crear(op->hilos);
+    CONFIRM_GOTO(pool, fin);
+    if (in) {
+        buffer = (unsigned char*) malloc(capacidad);
+        CONFIRM_GOTO(buffer, fin);
+    }
+
+    for (;;) {
+        const unsigned char* actual;
+        size_t cuantos;
+        size_t usados = 0;
+        int cantidad = 0;
+        int error = 0;
+        int k;
+
+        /* Bytes de la tanda */
+        if (in) {
+            cuantos = fread(buffer, 1, capacidad, in);
+            if (ferror(in)) {
+                perror("Error reading file");
+                goto fin;
+            }
+            actual = buffer;
+        } else {
+            cuantos = n - inicio < capacidad ? n - inicio : capacidad;
+            actual = datos + inicio;
+            inicio += cuantos;
+        }
+        if (cuantos == 0) {
+            break;
+        }
+
+        /* Donde termina cada bloque: cada op->tamano_bloque bytes, o donde
+           cambia el contenido. Las regiones no dependen de la cantidad de
+           hilos, asi que los cortes tampoco */
+        if (op->nivel > 1) {
+            int regiones = 0;
+            for (usados = 0; usados < cuantos; usados += region) {
+                trabajo_division* d = &divisiones[regiones];
+                d->datos = actual + usados;
+                d->n = cuantos - usados < region ? cuantos - usados : region;
+                d->op = op;
+                d->cortes = cortes + (size_t) regiones * por_region;
+                d->lugar = por_region;
+                d->tarea.funcion = dividir_region;
+                d->tarea.arg = d;
+                pool_agregar(pool, &d->tarea);
+                regiones++;
+            }
+            pool_esperar(pool);
+            for (k = 0; k < regiones; k++) {
+                trabajo_division* d = &divisiones[k];
+                int r;
+                CONFIRM_GOTO(d->cantidad > 0, fin);
+                for (r = 0; r < d->cantidad; r++) {
+                    cortes[cantidad++] = (size_t) (d->datos - actual) + d->cortes[r];
+                }
+            }
+        } else {
+            while (usados < cuantos) {
+                usados += cuantos - usados < op->tamano_bloque ? cuantos - usados : op->tamano_bloque;
+                cortes[cantidad++] = usados;
+            }
+        }
+
+        /* Analizar la tanda en paralelo */
+        usados = 0;
+        for (k = 0; k < cantidad; k++) {
+            trabajo_bloque* t = &trabajos[k];
+            t->datos = actual + usados;
+            t->n = cortes[k] - usados;
+            t->max_bits = op->max_bits;
+            t->tarea.funcion = analizar_bloque;
+            t->tarea.arg = t;
+            pool_agregar(pool, &t->tarea);
+            usados = cortes[k];
+        }
+        pool_esperar(pool);
+
+        /* Elegir las tablas en orden y codificar en paralelo */
+        for (k = 0; k < cantidad; k++) {
+            trabajo_bloque* t = &trabajos[k];
+            int reusa = hay_vigente && reusar_tabla(t->frecuencias, t->longitudes, vigente);
+            uint64_t codigos = reusa ? bytes_codigos(t->frecuencias, vigente, 0)
+                                     : bytes_codigos(t->frecuencias, t->longitudes, 1);
+            if (t->distintos == 1) {
+                t->tipo = BLOQUE_UNICO;
+            } else if (t->rle < codigos && t->rle < t->n) {
+                t->tipo = BLOQUE_RLE;
+            } else if (codigos >= t->n) {
+                t->tipo = BLOQUE_CRUDO;
+            } else if (reusa) {
+                t->tipo = BLOQUE_REUSA;
+            } else {
+                t->tipo = BLOQUE_HUFFMAN;
+                memcpy(vigente, t->longitudes, NUM_CHARS);
+                hay_vigente = 1;
+            }
+            memcpy(t->tabla, vigente, NUM_CHARS);
+            t->tarea.funcion = comprimir_bloque;
+            pool_agregar(pool, &t->tarea);
+        }
+
+        /* Escribir en orden cada bloque apenas termina */
+        for (k = 0; k < cantidad; k++) {
+            trabajo_bloque* t = &trabajos[k];
+            int bytes = -1;
+            pool_esperar_tarea(pool, &t->tarea);
+            if (!error && t->error == 0) {
+                bytes = escribir_bloque(out, &t->b);
+            }
+            if (bytes < 0 || 0 != agregar_indice(&ix, (uint64_t) bytes, (uint64_t) t->n)) {
+                error = 1;
+            }
+            free(t->b.datos);
+        }
+        CONFIRM_GOTO(!error, fin);
+    }
+
+    CONFIRM_GOTO(fputc(BLOQUE_FIN, out) != EOF, fin);
+    CONFIRM_GOTO(0 == escribir_indice(out, &ix), fin);
+    resultado = 0;
+
+fin:
+    pool_destruir(pool);
+    free(trabajos);
+    free(divisiones);
+    free(cortes);
+    free(buffer);
+    free(ix.datos);
+    return resultado;
+}
+
+/*
+  Descomprime el FORMATO_BLOQUES (ver comprimir_bloques()): in esta justo
+  despues del byte de formato y out recien creado.
+  
+  Si se conoce el tamano original y out se puede mapear, cada bloque se
+  decodifica directamente en su lugar del archivo; si no, en un buffer
+  que se escribe con fwrite().
+  
+  Retorna 0 si no hay errores.
+*/
+static int descomprimir_bloques(FILE* in, FILE* out) {
+    uint64_t total;
+    uint64_t escritos = 0;
+    Mapa mapa = NULL;
+    decodificador* d = NULL;
+    int hay_tabla = 0;
+    unsigned char* comprimido = NULL;
+    size_t capacidad_comprimido = 0;
+    unsigned char* salida = NULL;
+    size_t capacidad_salida = 0;
+    int resultado = -1;
+
+    CONFIRM_TRUE(0 == leer_varint(in, &total), -1);
+    d = (decodificador*) malloc(sizeof(decodificador));
+    CONFIRM_GOTO(d, fin);
+    if (total > 1 && total - 1 <= (size_t) -1) {
+        mapa = mapa_crear(out, (size_t) (total - 1));
+    }
+
+    for (;;) {
+        int tipo = fgetc(in);
+        uint64_t original;
+        uint64_t tamano;
+        unsigned char* destino;
+        BitStream bs;
+        int ok;
+
+        if (tipo == BLOQUE_FIN) {
+            break;
+        }
+        CONFIRM_GOTO(tipo == BLOQUE_HUFFMAN || tipo == BLOQUE_CRUDO || tipo == BLOQUE_UNICO || tipo == BLOQUE_RLE
+                     || (tipo == BLOQUE_REUSA && hay_tabla), fin);
+        CONFIRM_GOTO(0 == leer_varint(in, &original) && 0 == leer_varint(in, &tamano), fin);
+        /* Cada codigo ocupa a lo sumo MAX_BITS bits */
+        CONFIRM_GOTO(original <= HUFFMAN_BLOQUE_MAXIMO && tamano <= original * (MAX_BITS / 8) + MAX_TABLA, fin);
+        CONFIRM_GOTO(tipo != BLOQUE_CRUDO || tamano == original, fin);
+        CONFIRM_GOTO(total == 0 || escritos + original <= total - 1, fin);
+
+        /* Leer los bytes comprimidos del bloque */
+        if (tipo != BLOQUE_CRUDO && tamano > capacidad_comprimido) {
+            unsigned char* nuevo = (unsigned char*) realloc(comprimido, (size_t) tamano);
+            CONFIRM_GOTO(nuevo, fin);
+            comprimido = nuevo;
+            capacidad_comprimido = (size_t) tamano;
+        }
+        if (tipo != BLOQUE_CRUDO) {
+            CONFIRM_GOTO(fread(comprimido, 1, (size_t) tamano, in) == (size_t) tamano, fin);
+        }
+
+        /* Donde van los bytes descomprimidos */
+        if (mapa) {
+            destino = mapa_destino(mapa) + escritos;
+        } else {
+            if (original > capacidad_salida) {
+                unsigned char* nuevo = (unsigned char*) realloc(salida, (size_t) original);
+                CONFIRM_GOTO(nuevo, fin);
+                salida = nuevo;
+                capacidad_salida = (size_t) original;
+            }
+            destino = salida;
+        }
+
+        /* Un BLOQUE_CRUDO se lee directamente en su lugar */
+        if (tipo == BLOQUE_CRUDO) {
+            CONFIRM_GOTO(fread(destino, 1, (size_t) original, in) == (size_t) original, fin);
+            if (!mapa) {
+                CONFIRM_GOTO(fwrite(destino, 1, (size_t) original, out) == (size_t) original, fin);
+            }
+            escritos += original;
+            continue;
+        }
+
+        if (tipo == BLOQUE_UNICO || tipo == BLOQUE_RLE) {
+            ok = 0 == decodificar_sin_tabla(tipo, comprimido, (size_t) tamano, destino, (size_t) original);
+        } else {
+            bs = OpenBitStreamMemory(comprimido, (size_t) tamano);
+            CONFIRM_GOTO(bs, fin);
+            ok = 1;
+            if (tipo == BLOQUE_HUFFMAN) {
+                unsigned char longitudes[NUM_CHARS];
+                ok = 0 == leer_longitudes(bs, longitudes) && 0 == crear_decodificador(longitudes, d);
+                hay_tabla = ok;
+            }
+            ok = ok && 0 == decodificar(bs, d, destino, (size_t) original);
+            CloseBitStream(bs);
+        }
+        CONFIRM_GOTO(ok, fin);
+
+        if (!mapa) {
+            CONFIRM_GOTO(fwrite(destino, 1, (size_t) original, out) == (size_t) original, fin);
+        }
+        escritos += original;
+    }
+    CONFIRM_GOTO(total == 0 || escritos == total - 1, fin);
+    resultado = 0;
+
+fin:
+    if (mapa && 0 != mapa_cerrar(mapa)) {
+        resultado = -1;
+    }
+    free(comprimido);
+    free(salida);
+    free(d);
+    return resultado;
+}
+
+/*
+  Igual que leer_varint() pero de los n bytes de p, desde *pos, que
+  queda despues del valor.
+*/
+static int leer_varint_memoria(const unsigned char* p, size_t n, size_t* pos, uint64_t* valor) {
+    int desplazamiento = 0;
+    int c;
+
+    *valor = 0;
+    do {
+        if (*pos >= n || desplazamiento > 63) {
+            return -1;
+        }
+        c = p[(*pos)++];
+        *valor |= (uint64_t) (c & 0x7F) << desplazamiento;
+        desplazamiento += 7;
+    } while (c & 0x80);
+    return 0;
+}
+
+/* Tarea del Pool: decodificar un bloque en su lugar del archivo de salida */
+static void descomprimir_bloque(void* arg) {
+    trabajo_descompresion* t = (trabajo_descompresion*) arg;
+    BitStream bs;
+    unsigned char longitudes[NUM_CHARS];
+
+    if (t->tipo == BLOQUE_CRUDO || t->tipo == BLOQUE_UNICO || t->tipo == BLOQUE_RLE) {
+        t->error = decodificar_sin_tabla(t->tipo, t->datos, t->tamano, t->destino, t->original);
+        return;
+    }
+    t->error = -1;
+    bs = OpenBitStreamMemory(t->datos, t->tamano);
+    if (!bs) {
+        return;
+    }
+    /* La tabla ya se armo antes; solo hay que saltearla */
+    if (t->tipo != BLOQUE_HUFFMAN || 0 == leer_longitudes(bs, longitudes)) {
+        t->error = decodificar(bs, t->d, t->destino, t->original);
+    }
+    CloseBitStream(bs);
+}
+
+/*
+  Descomprime el FORMATO_BLOQUES del archivo entrada con hilos hilos,
+  usando el indice del final (ver escribir_indice()) para saber donde
+  esta cada bloque y donde va en out, que se mapea con su tamano final.
+  
+  Los bloques se reparten de a tandas en un Pool. Las tablas se arman
+  en orden antes de agregar cada tanda, porque un BLOQUE_REUSA necesita
+  la del ultimo bloque que mando una, y despues cada hilo decodifica
+  sus bloques directamente en el archivo de salida.
+  
+  Retorna 0 si no hay errores, -1 si los hay, o 1 si el archivo no tiene
+  indice o la salida no se puede mapear (y entonces hay que usar
+  descomprimir_bloques()).
+*/
+static int descomprimir_bloques_hilos(const char* entrada, FILE* out, int hilos) {
+    Mapa archivo = NULL;
+    Mapa mapa = NULL;
+    Pool pool = NULL;
+    trabajo_descompresion* trabajos = NULL;
+    decodificador* anterior = NULL;
+    const decodificador* vigente = NULL;
+    const unsigned char* p;
+    size_t n;
+    size_t pos = 1;
+    size_t pos_indice;
+    size_t fin_indice;
+    size_t largo;
+    size_t inicio_bloques;
+    uint64_t total;
+    uint64_t bloques;
+    uint64_t k;
+    uint64_t bytes;
+    uint64_t original;
+    uint64_t suma_bytes = 0;
+    uint64_t suma_original = 0;
+    uint64_t escritos = 0;
+    int tanda = hilos * BLOQUES_POR_HILO_DESCOMPRESION;
+    int resultado = 1;
+    int i;
+
+    archivo = mapa_abrir(entrada);
+    CONFIRM_TRUE(archivo, -1);
+    p = mapa_datos(archivo);
+    n = mapa_tamano(archivo);
+
+    /* Cabecera y cola del indice; si no estan, se descomprime sin indice */
+    if (n < 1 + 1 + 1 + INDICE_COLA || 0 != leer_varint_memoria(p, n, &pos, &total)) {
+        goto fin;
+    }
+    inicio_bloques = pos;
+    largo = 0;
+    for (i = 0; i < 4; i++) {
+        if (p[n - 4 + i] != (unsigned char) (INDICE_MARCA >> (8 * i))) {
+            goto fin;
+        }
+        largo |= (size_t) p[n - INDICE_COLA + i] << (8 * i);
+    }
+    resultado = -1;
+    CONFIRM_GOTO(largo + INDICE_COLA + 1 + inicio_bloques <= n, fin);
+    fin_indice = n - INDICE_COLA;
+    pos_indice = fin_indice - largo;
+    CONFIRM_GOTO(p[pos_indice - 1] == BLOQUE_FIN, fin);
+
+    /* Revisar que el indice cubre exactamente los bloques y el archivo original */
+    pos = pos_indice;
+    CONFIRM_GOTO(0 == leer_varint_memoria(p, fin_indice, &pos, &bloques), fin);
+    for (k = 0; k < bloques; k++) {
+        CONFIRM_GOTO(0 == leer_varint_memoria(p, fin_indice, &pos, &bytes), fin);
+        CONFIRM_GOTO(0 == leer_varint_memoria(p, fin_indice, &pos, &original), fin);
+        CONFIRM_GOTO(bytes <= n && original <= HUFFMAN_BLOQUE_MAXIMO, fin);
+        suma_bytes += bytes;
+        suma_original += original;
+        CONFIRM_GOTO(suma_bytes <= n && (total == 0 || suma_original <= total - 1), fin);
+    }
+    CONFIRM_GOTO(pos == fin_indice && inicio_bloques + suma_bytes == pos_indice - 1, fin);
+    CONFIRM_GOTO(total == 0 || suma_original == total - 1, fin);
+
+    /* Comprimido desde un flujo: el tamano original sale del indice */
+    total = suma_original + 1;
+
+    if (total == 1) {
+        resultado = 0;    /* archivo vacio */
+        goto fin;
+    }
+    if (total - 1 > (size_t) -1 || (mapa = mapa_crear(out, (size_t) (total - 1))) == NULL) {
+        resultado = 1;
+        goto fin;
+    }
+
+    trabajos = (trabajo_descompresion*) malloc(tanda * sizeof(trabajo_descompresion));
+    anterior = (decodificador*) malloc(sizeof(decodificador));
+    pool = pool_crear(hilos);
+    CONFIRM_GOTO(trabajos && anterior && pool, fin);
+
+    /* Recorrer otra vez el indice, de a tandas */
+    pos = pos_indice;
+    leer_varint_memoria(p, fin_indice, &pos, &bloques);
+    suma_bytes = inicio_bloques;
+    k = 0;
+    while (k < bloques) {
+        int cantidad = 0;
+        int error = 0;
+
+        while (cantidad < tanda && k < bloques) {
+            trabajo_descompresion* t = &trabajos[cantidad];
+            size_t cabecera = (size_t) suma_bytes;
+            uint64_t en_cabecera;
+            uint64_t tamano;
+
+            error = 1;
+            leer_varint_memoria(p, fin_indice, &pos, &bytes);
+            leer_varint_memoria(p, fin_indice, &pos, &original);
+            suma_bytes += bytes;
+            k++;
+
+            /* Cabecera del bloque: tiene que coincidir con el indice */
+            t->tipo = p[cabecera++];
+            CONFIRM_GOTO(0 == leer_varint_memoria(p, (size_t) suma_bytes, &cabecera, &en_cabecera), espera);
+            CONFIRM_GOTO(0 == leer_varint_memoria(p, (size_t) suma_bytes, &cabecera, &tamano), espera);
+            CONFIRM_GOTO(en_cabecera == original && cabecera + tamano == suma_bytes, espera);
+            CONFIRM_GOTO(original <= HUFFMAN_BLOQUE_MAXIMO && tamano <= original * (MAX_BITS / 8) + MAX_TABLA, espera);
+            t->datos = p + cabecera;
+            t->tamano = (size_t) tamano;
+            t->original = (size_t) original;
+            t->destino = mapa_destino(mapa) + escritos;
+            escritos += original;
+
+            /* Tabla del bloque */
+            if (t->tipo == BLOQUE_HUFFMAN) {
+                unsigned char longitudes[NUM_CHARS];
+                BitStream bs = OpenBitStreamMemory(t->datos, t->tamano);
+                int ok = bs && 0 == leer_longitudes(bs, longitudes) && 0 == crear_decodificador(longitudes, &t->propia);
+                CloseBitStream(bs);
+                CONFIRM_GOTO(ok, espera);
+                vigente = &t->propia;
+            } else if (t->tipo == BLOQUE_CRUDO || t->tipo == BLOQUE_UNICO || t->tipo == BLOQUE_RLE) {
+                /* Sin tabla: se revisa al decodificar */
+            } else {
+                CONFIRM_GOTO(t->tipo == BLOQUE_REUSA && vigente, espera);
+            }
+            t->d = vigente;
+
+            t->tarea.funcion = descomprimir_bloque;
+            t->tarea.arg = t;
+            pool_agregar(pool, &t->tarea);
+            cantidad++;
+            error = 0;
+        }
+
+espera:
+        pool_esperar(pool);
+        for (i = 0; i < cantidad; i++) {
+            error |= trabajos[i].error != 0;
+        }
+        CONFIRM_GOTO(!error, fin);
+
+        /* La tabla vigente sigue en la proxima tanda, que reusa los trabajos */
+        if (vigente && vigente != anterior) {
+            memcpy(anterior, vigente, sizeof(decodificador));
+            vigente = anterior;
+        }
+    }
+    resultado = 0;
+
+fin:
+    pool_destruir(pool);
+    if (mapa && 0 != mapa_cerrar(mapa)) {
+        resultado = -1;
+    }
+    mapa_cerrar(archivo);
+    free(trabajos);
+    free(anterior);
+    return resultado;
+}
+
+/*
+  Comprime lo que se lee de in hasta el final en out con el
+  FORMATO_ADAPTATIVO, en una sola pasada:
+  
+    - 8 bits: FORMATO_ADAPTATIVO
+    - el codigo de cada byte con el arbol adaptativo (ver adaptativo.h),
+      que se actualiza despues de cada uno
+    - el codigo de ADAPTATIVO_FIN
+    - igual que CloseBitStream(): el ultimo byte completado con ceros y
+      la cantidad de bits validos en el
+  
+  No hay tabla ni tamano, asi que sirve para mensajes cortos y para
+  flujos que no se pueden guardar de a bloques. Codifica y decodifica
+  mas lento que una tabla fija.
+  
+  Se codifica lo que ya llego a in, sin esperar a llenar el buffer, y
+  antes de esperar mas se escriben en out los bytes completos: en una
+  tuberia cada mensaje sale apenas entra (salvo los bits de su ultimo
+  byte, que salen con el siguiente).
+  
+  Retorna 0 si no hay errores.
+*/
+static int comprimir_adaptativo(FILE* in, FILE* out) {
+    BitStream bs = NULL;
+    Adaptativo arbol = NULL;
+    unsigned char* buffer = NULL;
+    long leidos;
+    int resultado = -1;
+
+    bs = OpenBitStreamFile(out, "w");
+    CONFIRM_TRUE(bs, -1);
+    arbol = adaptativo_crear();
+    buffer = (unsigned char*) malloc(SALIDA_BLOQUE);
+    CONFIRM_GOTO(arbol && buffer, fin);
+
+    PutBits(bs, FORMATO_ADAPTATIVO, 8);
+    while ((leidos = LeerDisponible(in, buffer, SALIDA_BLOQUE)) > 0) {
+        long i;
+        for (i = 0; i < leidos; i++) {
+            adaptativo_codificar(arbol, bs, buffer[i]);
+        }
+        CONFIRM_GOTO(0 == FlushBitStream(bs), fin);
+    }
+    if (leidos < 0) {
+        perror("Error reading file");
+        goto fin;
+    }
+    adaptativo_codificar(arbol, bs, ADAPTATIVO_FIN);
+    resultado = 0;
+
+fin:
+    if (0 != CloseBitStream(bs)) {
+        resultado = -1;
+    }
+    adaptativo_destruir(arbol);
+    free(buffer);
+    return resultado;
+}
+
+/*
+  Descomprime el FORMATO_ADAPTATIVO (ver comprimir_adaptativo()): in
+  esta justo despues del byte de formato, leido sin stdio. Lo que sigue
+  a ADAPTATIVO_FIN es relleno.
+  
+  Se decodifica lo que ya llego a in y cada byte va a out con putc(),
+  que antes de esperar mas datos se vacia (ver OpenBitStreamFlujo()).
+  El final lo marca ADAPTATIVO_FIN, asi que no hace falta esperar el
+  byte de CloseBitStream() para saber cuantos bits valen.
+  
+  Retorna 0 si no hay errores.
+*/
+static int descomprimir_adaptativo(FILE* in, FILE* out) {
+    BitStream bs = NULL;
+    Adaptativo arbol = NULL;
+    int simbolo;
+    int resultado = -1;
+
+    bs = OpenBitStreamFlujo(in, out);
+    CONFIRM_TRUE(bs, -1);
+    arbol = adaptativo_crear();
+    CONFIRM_GOTO(arbol, fin);
+
+    while ((simbolo = adaptativo_decodificar(arbol, bs)) != ADAPTATIVO_FIN) {
+        CONFIRM_GOTO(simbolo >= 0, fin);
+        CONFIRM_GOTO(putc(simbolo, out) != EOF, fin);
+    }
+    resultado = 0;
+
+fin:
+    CloseBitStream(bs);
+    adaptativo_destruir(arbol);
+    return resultado;
+}
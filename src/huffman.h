@@ -1,24 +1,90 @@
-#ifndef DEFINE_HUFFMAN_H
-#define DEFINE_HUFFMAN_H
-
-/*
-  Comprime archivo entrada y lo escriba a archivo salida.
-  
-  Retorna 0 si no hay errores.
-*/
-int comprimir(char* entrada, char* salida);
-
-/*
-  Descomprime archivo entrada y lo escriba a archivo salida.
-  
-  Retorna 0 si no hay errores.
-*/
-int descomprimir(char* entrada, char* salida);
-
-/*
-	ejecuta el codigo de ejemplo para manipulacion de campobits y bitstream 
-*/
-void campobitsDemo();
-
-
-#endif
+#ifndef DEFINE_HUFFMAN_H
+#define DEFINE_HUFFMAN_H
+
+#include <stddef.h>
+
+/* Longitud maxima de los codigos si no se especifica otra */
+#define HUFFMAN_MAX_BITS_DEFECTO 15
+
+/* Hilos que se usan si no se especifica otra cantidad */
+#define HUFFMAN_HILOS_DEFECTO 1
+
+/* Tamano de los bloques si no se especifica otro, y el mayor posible */
+#define HUFFMAN_BLOQUE_DEFECTO (1 << 20)
+#define HUFFMAN_BLOQUE_MAXIMO (64 << 20)
+
+/* Nivel de compresion si no se especifica otro, y el mayor posible */
+#define HUFFMAN_NIVEL_DEFECTO 1
+#define HUFFMAN_NIVEL_MAXIMO 3
+
+/*
+  Opciones de compresion y descompresion.
+  
+  max_bits - longitud maxima de un codigo de Huffman (1..32). Si hay
+             demasiados caracteres distintos para esa longitud se usa
+             la menor que alcance.
+  hilos    - cantidad de hilos (1 o mas): cada uno comprime o descomprime
+             bloques distintos, o con un solo bloque cuentan juntos las
+             frecuencias y codifican tramos distintos del archivo.
+  tamano_bloque - bytes de cada bloque, que lleva su propia tabla
+             (hasta HUFFMAN_BLOQUE_MAXIMO). 0 para una sola tabla para
+             todo el archivo, salvo que con ella ocupe mas que sin
+             comprimir: entonces se usa HUFFMAN_BLOQUE_DEFECTO.
+  adaptativo - 1 para comprimir en una sola pasada con un arbol
+             adaptativo, sin tabla (no usa las opciones anteriores).
+  nivel    - 1 (el mas rapido) a HUFFMAN_NIVEL_MAXIMO. En el 1 los bloques
+             tienen tamano_bloque bytes; en los otros se cortan donde
+             cambia el contenido (a lo sumo tamano_bloque bytes), buscando
+             entre mas posiciones cuanto mayor es el nivel.
+*/
+typedef struct _huffman_opciones {
+    int max_bits;
+    int hilos;
+    size_t tamano_bloque;
+    int adaptativo;
+    int nivel;
+} huffman_opciones;
+
+/*
+  Llena op con los valores por defecto.
+*/
+void huffman_opciones_defecto(huffman_opciones* op);
+
+/*
+  Comprime archivo entrada y lo escriba a archivo salida.
+  
+  Retorna 0 si no hay errores.
+*/
+int comprimir(char* entrada, char* salida);
+
+/*
+  Igual que comprimir() pero con las opciones dadas.
+  
+  Si entrada es "-" se comprime la entrada estandar a medida que llega,
+  siempre por bloques (con tamano_bloque 0 se usa HUFFMAN_BLOQUE_DEFECTO),
+  y si salida es "-" se escribe en la salida estandar.
+*/
+int comprimir_opciones(char* entrada, char* salida, const huffman_opciones* op);
+
+/*
+  Descomprime archivo entrada y lo escriba a archivo salida.
+  
+  Retorna 0 si no hay errores.
+*/
+int descomprimir(char* entrada, char* salida);
+
+/*
+  Igual que descomprimir() pero con las opciones dadas (solo se usa
+  hilos, para descomprimir varios bloques a la vez). entrada y salida
+  pueden ser "-" como en comprimir_opciones(); desde la entrada estandar
+  los bloques se descomprimen en orden.
+*/
+int descomprimir_opciones(char* entrada, char* salida, const huffman_opciones* op);
+
+/*
+	ejecuta el codigo de ejemplo para manipulacion de campobits y bitstream 
+*/
+void campobitsDemo();
+
+
+#endif
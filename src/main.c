@@ -1,44 +1,89 @@
-#include <stdlib.h>
-#include <stdio.h>
-#include <string.h>
-
-#include "huffman.h"
-
-void forma_de_uso() {
-    printf("\nCodificador de Huffman:\n\n");
-    printf("\tProy1.exe [comprimir|descomprimir] archivoent archivosal\n");
-}
-
-
-/* Este es un main() con argumentos.
-    argc - numero de argumentos (incluyendo el ejecutable)
-    argv - vector de argumentos
-*/
-int main(int argc, char* argv[]) {
-    int errores = 0;
-
-    // comentar campobitsDemo() es solo de ayuda para comenzar con campobits BitStream y Arbol
-    //campobitsDemo();
-
-    /* Revisar que estan bien los parametros */
-    if (argc != 4) {
-        forma_de_uso();
-        return 1;
-    }
-
-    
-
-    if (0 == strcmp("comprimir", argv[1])) {
-        errores = comprimir(argv[2], argv[3]);
-    } else {
-        errores = descomprimir(argv[2], argv[3]);
-    }
-
-
-    /*
-    char** str;
-    printf("Presione Enter para continuar ... %c",str);
-    scanf("%s",&str);
-    */
-    return errores;
-}
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "huffman.h"
+
+void forma_de_uso() {
+    printf("\nCodificador de Huffman:\n\n");
+    printf("\tProy1.exe [opciones] [comprimir|descomprimir] archivoent archivosal\n\n");
+    printf("Opciones:\n");
+    printf("\t-m N\tlongitud maxima de los codigos, 1..32 (por defecto %d)\n", HUFFMAN_MAX_BITS_DEFECTO);
+    printf("\t-j N\thilos para comprimir y descomprimir (por defecto %d)\n", HUFFMAN_HILOS_DEFECTO);
+    printf("\t-b N\tbloques de N KB, cada uno con su tabla, 0 para una sola tabla\n");
+    printf("\t\t(por defecto %d, a lo sumo %d)\n", HUFFMAN_BLOQUE_DEFECTO >> 10, HUFFMAN_BLOQUE_MAXIMO >> 10);
+    printf("\t-l N\tnivel de compresion, 1..%d: desde el 2 los bloques se cortan donde\n", HUFFMAN_NIVEL_MAXIMO);
+    printf("\t\tcambia el contenido, mas lento (por defecto %d)\n", HUFFMAN_NIVEL_DEFECTO);
+    printf("\t-a\tHuffman adaptativo: una sola pasada y sin tabla\n");
+    printf("\nUse - como archivoent o archivosal para la entrada o salida estandar.\n");
+}
+
+
+/* Este es un main() con argumentos.
+    argc - numero de argumentos (incluyendo el ejecutable)
+    argv - vector de argumentos
+*/
+int main(int argc, char* argv[]) {
+    int errores = 0;
+    huffman_opciones opciones;
+    char* parametros[3];
+    int n = 0;
+    int i;
+
+    // comentar campobitsDemo() es solo de ayuda para comenzar con campobits BitStream y Arbol
+    //campobitsDemo();
+
+    huffman_opciones_defecto(&opciones);
+
+    /* Separar las opciones (-x valor) de los parametros */
+    for (i = 1; i < argc; i++) {
+        if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            if (0 == strcmp("-m", argv[i]) && i + 1 < argc) {
+                opciones.max_bits = atoi(argv[++i]);
+            } else if (0 == strcmp("-j", argv[i]) && i + 1 < argc) {
+                opciones.hilos = atoi(argv[++i]);
+            } else if (0 == strcmp("-l", argv[i]) && i + 1 < argc) {
+                opciones.nivel = atoi(argv[++i]);
+            } else if (0 == strcmp("-a", argv[i])) {
+                opciones.adaptativo = 1;
+            } else if (0 == strcmp("-b", argv[i]) && i + 1 < argc) {
+                int kb = atoi(argv[++i]);
+                if (kb < 0 || kb > (HUFFMAN_BLOQUE_MAXIMO >> 10)) {
+                    forma_de_uso();
+                    return 1;
+                }
+                opciones.tamano_bloque = (size_t) kb << 10;
+            } else {
+                forma_de_uso();
+                return 1;
+            }
+        } else if (n < 3) {
+            parametros[n++] = argv[i];
+        } else {
+            forma_de_uso();
+            return 1;
+        }
+    }
+
+    /* Revisar que estan bien los parametros */
+    if (n != 3) {
+        forma_de_uso();
+        return 1;
+    }
+
+    
+
+    if (0 == strcmp("comprimir", parametros[0])) {
+        errores = comprimir_opciones(parametros[1], parametros[2], &opciones);
+    } else {
+        errores = descomprimir_opciones(parametros[1], parametros[2], &opciones);
+    }
+
+
+    /*
+    char** str;
+    printf("Presione Enter para continuar ... %c",str);
+    scanf("%s",&str);
+    */
+    return errores;
+}
@@ -0,0 +1,197 @@
+/** Nota: mi cabecera debe ir antes que nada */
+#include "mapa.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#define MAPA_MMAP
+#endif
+
+#pragma warning(disable : 4996)
+
+/* Tamano inicial del buffer cuando el archivo no se puede mapear */
+#define MAPA_BLOQUE (1 << 20)
+
+struct _Mapa {
+    unsigned char* datos;
+    size_t tamano;
+    int mapeado;    /* 1 si datos viene de mmap(), 0 si de malloc() */
+};
+
+/* Lee f hasta el final en un buffer que va duplicando su tamano */
+static int leer_todo(FILE* f, struct _Mapa* m) {
+    size_t capacidad = MAPA_BLOQUE;
+    size_t leidos;
+
+    m->datos = (unsigned char*) malloc(capacidad);
+    if (!m->datos) {
+        return -1;
+    }
+    m->tamano = 0;
+    while ((leidos = fread(m->datos + m->tamano, 1, capacidad - m->tamano, f)) > 0) {
+        m->tamano += leidos;
+        if (m->tamano == capacidad) {
+            unsigned char* nuevo = (unsigned char*) realloc(m->datos, capacidad * 2);
+            if (!nuevo) {
+                free(m->datos);
+                m->datos = NULL;
+                return -1;
+            }
+            m->datos = nuevo;
+            capacidad *= 2;
+        }
+    }
+    return ferror(f) ? -1 : 0;
+}
+
+Mapa mapa_abrir(const char* nombre) {
+    struct _Mapa* m;
+    FILE* f;
+
+    m = (struct _Mapa*) malloc(sizeof(struct _Mapa));
+    if (!m) {
+        return NULL;
+    }
+    m->datos = NULL;
+    m->tamano = 0;
+    m->mapeado = 0;
+
+    f = fopen(nombre, "rb");
+    if (!f) {
+        perror("mapa_abrir");
+        free(m);
+        return NULL;
+    }
+
+#ifdef MAPA_MMAP
+    {
+        struct stat info;
+        if (fstat(fileno(f), &info) == 0 && S_ISREG(info.st_mode)) {
+            if (info.st_size == 0) {
+                /* mmap() no acepta largo 0; un archivo vacio no tiene datos */
+                fclose(f);
+                return m;
+            }
+            if ((unsigned long long) info.st_size <= (size_t) -1) {
+                void* p = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+                if (p != MAP_FAILED) {
+                    madvise(p, (size_t) info.st_size, MADV_SEQUENTIAL);
+                    m->datos = (unsigned char*) p;
+                    m->tamano = (size_t) info.st_size;
+                    m->mapeado = 1;
+                    /* El mapeo sigue valido despues de cerrar el archivo */
+                    fclose(f);
+                    return m;
+                }
+            }
+        }
+    }
+#endif
+
+    if (leer_todo(f, m) != 0) {
+        perror("mapa_abrir");
+        fclose(f);
+        free(m->datos);
+        free(m);
+        return NULL;
+    }
+    fclose(f);
+    return m;
+}
+
+Mapa mapa_crear(FILE* f, size_t tamano) {
+#ifdef MAPA_MMAP
+    struct _Mapa* m;
+    struct stat st;
+    void* p;
+
+    /* mmap() no acepta largo 0, y el tamano tiene que caber en un off_t
+       para ftruncate() */
+    if (tamano == 0 || (off_t) tamano < 0 || (size_t) (off_t) tamano != tamano) {
+        return NULL;
+    }
+    /* Solo un archivo comun abierto para lectura y escritura: la salida
+       estandar redirigida a un archivo suele estar abierta solo para
+       escritura, y ftruncate() lo agrandaria aunque mmap() falle */
+    if (fstat(fileno(f), &st) != 0 || !S_ISREG(st.st_mode) || (fcntl(fileno(f), F_GETFL) & O_ACCMODE) != O_RDWR) {
+        return NULL;
+    }
+    fflush(f);
+    if (ftruncate(fileno(f), (off_t) tamano) != 0) {
+        return NULL;
+    }
+    p = mmap(NULL, tamano, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(f), 0);
+    if (p == MAP_FAILED) {
+        return NULL;
+    }
+    m = (struct _Mapa*) malloc(sizeof(struct _Mapa));
+    if (!m) {
+        munmap(p, tamano);
+        return NULL;
+    }
+    m->datos = (unsigned char*) p;
+    m->tamano = tamano;
+    m->mapeado = 1;
+    return m;
+#else
+    (void) f;
+    (void) tamano;
+    return NULL;
+#endif
+}
+
+int64_t mapa_restante(FILE* f) {
+#ifdef MAPA_MMAP
+    struct stat st;
+    off_t posicion;
+
+    if (fstat(fileno(f), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return -1;
+    }
+    posicion = ftello(f);
+    if (posicion < 0 || posicion > st.st_size) {
+        return -1;
+    }
+    return (int64_t) (st.st_size - posicion);
+#else
+    (void) f;
+    return -1;
+#endif
+}
+
+const unsigned char* mapa_datos(Mapa m) {
+    return ((struct _Mapa*) m)->datos;
+}
+
+unsigned char* mapa_destino(Mapa m) {
+    return ((struct _Mapa*) m)->datos;
+}
+
+size_t mapa_tamano(Mapa m) {
+    return ((struct _Mapa*) m)->tamano;
+}
+
+int mapa_cerrar(Mapa mapa) {
+    struct _Mapa* m = (struct _Mapa*) mapa;
+    int rt = 0;
+    if (!m) {
+        return 0;
+    }
+#ifdef MAPA_MMAP
+    if (m->mapeado) {
+        rt = munmap(m->datos, m->tamano);
+        free(m);
+        return rt;
+    }
+#endif
+    free(m->datos);
+    free(m);
+    return rt;
+}
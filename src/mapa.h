@@ -0,0 +1,53 @@
+/* Estas lineas hacen que este archivo se incluya solamente una vez por modulo */
+#ifndef DEFINE_MAPA_H
+#define DEFINE_MAPA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Tipo opaco Mapa - el contenido entero de un archivo visto como memoria */
+typedef void* Mapa;
+
+/* Abre el archivo nombre para leerlo entero como un bloque de memoria.
+
+   Si es un archivo regular se mapea con mmap() (sin copiarlo) y se
+   avisa al sistema que se va a leer de principio a fin. Si no se puede
+   mapear (tuberias, dispositivos, o plataformas sin mmap) se lee entero
+   a un buffer con fread().
+
+   Retorna NULL si falla.
+*/
+Mapa mapa_abrir(const char* nombre);
+
+/* Agranda el archivo f (abierto para lectura y escritura) a tamano
+   bytes con ftruncate() y lo mapea con mmap(), para escribir su
+   contenido directamente en memoria con mapa_destino().
+
+   Retorna NULL si el archivo no se puede mapear (tuberias, abierto solo
+   para escritura, tamano 0, o plataformas sin mmap); en ese caso hay que escribirlo de otra forma.
+   f sigue abierto y el que lo abrio lo cierra despues de mapa_cerrar().
+*/
+Mapa mapa_crear(FILE* f, size_t tamano);
+
+/* Retorna cuantos bytes quedan por leer de f desde la posicion actual,
+   o -1 si no se sabe (tuberias, dispositivos, o plataformas sin mmap).
+*/
+int64_t mapa_restante(FILE* f);
+
+/* Retorna el primer byte del contenido (puede ser NULL si esta vacio) */
+const unsigned char* mapa_datos(Mapa m);
+
+/* Retorna donde escribir el contenido de un mapa hecho con mapa_crear() */
+unsigned char* mapa_destino(Mapa m);
+
+/* Retorna la cantidad de bytes del contenido */
+size_t mapa_tamano(Mapa m);
+
+/* Libera el mapa. Despues de llamar esto no utilice sus datos.
+
+   Retorna 0 si no hay errores.
+*/
+int mapa_cerrar(Mapa m);
+
+#endif
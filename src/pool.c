@@ -0,0 +1,311 @@
+/** Nota: mi cabecera debe ir antes que nada */
+#include "pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#define POOL_HILOS
+#endif
+
+#ifdef POOL_HILOS
+
+/* Capacidad inicial de cada cola */
+#define COLA_INICIAL 16
+
+/* Cola de tareas de un hilo: el dueno agrega y saca por el final, los
+   otros roban por el principio (las mas viejas) */
+typedef struct _cola {
+    pthread_mutex_t m;
+    pool_tarea** items;
+    int inicio;
+    int fin;
+    int capacidad;
+} cola;
+
+struct _Pool {
+    int hilos;              /* hilos propios (sin contar al que llama) */
+    int creados;            /* los que se pudieron crear */
+    pthread_t* ids;
+    cola* colas;            /* hilos + 1, la ultima es la del que llama */
+    int siguiente;          /* proxima cola donde agregar */
+    pthread_mutex_t m;      /* protege lo que sigue */
+    pthread_cond_t trabajo; /* hay tareas en alguna cola o hay que terminar */
+    pthread_cond_t listo;   /* termino alguna tarea */
+    int pendientes;         /* tareas en las colas */
+    int activas;            /* tareas agregadas que no terminaron */
+    int terminar;
+};
+
+/* Agrega t al final de la cola c, agrandandola si hace falta */
+static int cola_agregar(cola* c, pool_tarea* t) {
+    pthread_mutex_lock(&c->m);
+    if (c->fin == c->capacidad) {
+        int cantidad = c->fin - c->inicio;
+        if (c->inicio > 0) {
+            memmove(c->items, c->items + c->inicio, cantidad * sizeof(pool_tarea*));
+        }
+        if (cantidad == c->capacidad) {
+            int capacidad = c->capacidad > 0 ? 2 * c->capacidad : COLA_INICIAL;
+            pool_tarea** nuevo = (pool_tarea**) realloc(c->items, capacidad * sizeof(pool_tarea*));
+            if (!nuevo) {
+                pthread_mutex_unlock(&c->m);
+                return -1;
+            }
+            c->items = nuevo;
+            c->capacidad = capacidad;
+        }
+        c->inicio = 0;
+        c->fin = cantidad;
+    }
+    c->items[c->fin++] = t;
+    pthread_mutex_unlock(&c->m);
+    return 0;
+}
+
+/* Saca una tarea de la cola c: la ultima si es del que saca, si no la primera */
+static pool_tarea* cola_sacar(cola* c, int propia) {
+    pool_tarea* t = NULL;
+    pthread_mutex_lock(&c->m);
+    if (c->inicio < c->fin) {
+        t = propia ? c->items[--c->fin] : c->items[c->inicio++];
+        if (c->inicio == c->fin) {
+            c->inicio = c->fin = 0;
+        }
+    }
+    pthread_mutex_unlock(&c->m);
+    return t;
+}
+
+/* Saca una tarea para el hilo de la cola yo: primero de la suya y si esta
+   vacia le roba a las demas */
+static pool_tarea* buscar_tarea(struct _Pool* p, int yo) {
+    pool_tarea* t = cola_sacar(&p->colas[yo], 1);
+    int i;
+
+    for (i = 1; !t && i <= p->hilos; i++) {
+        t = cola_sacar(&p->colas[(yo + i) % (p->hilos + 1)], 0);
+    }
+    if (t) {
+        pthread_mutex_lock(&p->m);
+        p->pendientes--;
+        pthread_mutex_unlock(&p->m);
+    }
+    return t;
+}
+
+static void ejecutar(struct _Pool* p, pool_tarea* t) {
+    t->funcion(t->arg);
+    pthread_mutex_lock(&p->m);
+    t->terminada = 1;
+    p->activas--;
+    pthread_cond_broadcast(&p->listo);
+    pthread_mutex_unlock(&p->m);
+}
+
+/* Lo que hace cada hilo propio hasta que se destruye el Pool */
+typedef struct _trabajador {
+    struct _Pool* p;
+    int yo;
+} trabajador;
+
+static void* trabajar(void* arg) {
+    struct _Pool* p = ((trabajador*) arg)->p;
+    int yo = ((trabajador*) arg)->yo;
+
+    free(arg);
+    for (;;) {
+        pool_tarea* t = buscar_tarea(p, yo);
+        if (t) {
+            ejecutar(p, t);
+            continue;
+        }
+        pthread_mutex_lock(&p->m);
+        while (p->pendientes == 0 && !p->terminar) {
+            pthread_cond_wait(&p->trabajo, &p->m);
+        }
+        if (p->pendientes == 0 && p->terminar) {
+            pthread_mutex_unlock(&p->m);
+            return NULL;
+        }
+        pthread_mutex_unlock(&p->m);
+    }
+}
+
+Pool pool_crear(int hilos) {
+    struct _Pool* p = (struct _Pool*) calloc(1, sizeof(struct _Pool));
+    int i;
+
+    if (!p) {
+        return NULL;
+    }
+    if (hilos < 1) {
+        hilos = 1;
+    }
+    p->hilos = hilos - 1;
+    p->colas = (cola*) calloc(hilos, sizeof(cola));
+    p->ids = (pthread_t*) calloc(hilos, sizeof(pthread_t));
+    if (!p->colas || !p->ids) {
+        free(p->colas);
+        free(p->ids);
+        free(p);
+        return NULL;
+    }
+    for (i = 0; i < hilos; i++) {
+        pthread_mutex_init(&p->colas[i].m, NULL);
+        p->colas[i].items = (pool_tarea**) malloc(COLA_INICIAL * sizeof(pool_tarea*));
+        p->colas[i].capacidad = p->colas[i].items ? COLA_INICIAL : 0;
+    }
+    pthread_mutex_init(&p->m, NULL);
+    pthread_cond_init(&p->trabajo, NULL);
+    pthread_cond_init(&p->listo, NULL);
+
+    /* Si no se pueden crear todos, se trabaja con los que haya: las
+       tareas de las colas sin dueno se las roban los demas */
+    for (i = 0; i < p->hilos; i++) {
+        trabajador* w = (trabajador*) malloc(sizeof(trabajador));
+        if (!w) {
+            break;
+        }
+        w->p = p;
+        w->yo = i;
+        if (pthread_create(&p->ids[i], NULL, trabajar, w) != 0) {
+            free(w);
+            break;
+        }
+        p->creados++;
+    }
+    return p;
+}
+
+void pool_agregar(Pool pool, pool_tarea* t) {
+    struct _Pool* p = (struct _Pool*) pool;
+    int c;
+
+    t->terminada = 0;
+    /* Se cuenta antes de publicarla: apenas esta en la cola otro hilo la
+       puede sacar y descontar, y los contadores no deben quedar negativos */
+    pthread_mutex_lock(&p->m);
+    c = p->siguiente;
+    p->siguiente = (p->siguiente + 1) % (p->hilos + 1);
+    p->pendientes++;
+    p->activas++;
+    pthread_mutex_unlock(&p->m);
+
+    if (cola_agregar(&p->colas[c], t) != 0) {
+        /* Sin memoria para encolarla: se deshace la cuenta y se ejecuta aca */
+        pthread_mutex_lock(&p->m);
+        p->pendientes--;
+        p->activas--;
+        pthread_cond_broadcast(&p->listo);
+        pthread_mutex_unlock(&p->m);
+        t->funcion(t->arg);
+        t->terminada = 1;
+        return;
+    }
+    pthread_mutex_lock(&p->m);
+    pthread_cond_signal(&p->trabajo);
+    pthread_mutex_unlock(&p->m);
+}
+
+/* Espera hasta que t termine, o si t es NULL hasta que terminen todas */
+static void esperar(struct _Pool* p, pool_tarea* t) {
+    for (;;) {
+        pool_tarea* otra;
+
+        pthread_mutex_lock(&p->m);
+        if (t ? t->terminada : p->activas == 0) {
+            pthread_mutex_unlock(&p->m);
+            return;
+        }
+        pthread_mutex_unlock(&p->m);
+
+        /* Mientras tanto, ayudar */
+        otra = buscar_tarea(p, p->hilos);
+        if (otra) {
+            ejecutar(p, otra);
+            continue;
+        }
+
+        pthread_mutex_lock(&p->m);
+        while (!(t ? t->terminada : p->activas == 0) && p->pendientes == 0) {
+            pthread_cond_wait(&p->listo, &p->m);
+        }
+        pthread_mutex_unlock(&p->m);
+    }
+}
+
+void pool_esperar_tarea(Pool p, pool_tarea* t) {
+    esperar((struct _Pool*) p, t);
+}
+
+void pool_esperar(Pool p) {
+    esperar((struct _Pool*) p, NULL);
+}
+
+void pool_destruir(Pool pool) {
+    struct _Pool* p = (struct _Pool*) pool;
+    int i;
+
+    if (!p) {
+        return;
+    }
+    esperar(p, NULL);
+    pthread_mutex_lock(&p->m);
+    p->terminar = 1;
+    pthread_cond_broadcast(&p->trabajo);
+    pthread_mutex_unlock(&p->m);
+    for (i = 0; i < p->creados; i++) {
+        pthread_join(p->ids[i], NULL);
+    }
+
+    for (i = 0; i <= p->hilos; i++) {
+        pthread_mutex_destroy(&p->colas[i].m);
+        free(p->colas[i].items);
+    }
+    pthread_mutex_destroy(&p->m);
+    pthread_cond_destroy(&p->trabajo);
+    pthread_cond_destroy(&p->listo);
+    free(p->colas);
+    free(p->ids);
+    free(p);
+}
+
+#else
+
+/* Sin hilos: cada tarea se ejecuta al agregarla */
+
+struct _Pool {
+    int hilos;
+};
+
+Pool pool_crear(int hilos) {
+    struct _Pool* p = (struct _Pool*) malloc(sizeof(struct _Pool));
+    (void) hilos;
+    if (p) {
+        p->hilos = 0;
+    }
+    return p;
+}
+
+void pool_agregar(Pool p, pool_tarea* t) {
+    (void) p;
+    t->funcion(t->arg);
+    t->terminada = 1;
+}
+
+void pool_esperar_tarea(Pool p, pool_tarea* t) {
+    (void) p;
+    (void) t;
+}
+
+void pool_esperar(Pool p) {
+    (void) p;
+}
+
+void pool_destruir(Pool p) {
+    free(p);
+}
+
+#endif
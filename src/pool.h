@@ -0,0 +1,44 @@
+/* Estas lineas hacen que este archivo se incluya solamente una vez por modulo */
+#ifndef DEFINE_POOL_H
+#define DEFINE_POOL_H
+
+/* Tipo opaco Pool - un grupo de hilos que ejecutan tareas */
+typedef void* Pool;
+
+/* Una tarea para el Pool. La memoria es del que la agrega y tiene que
+   existir hasta que termine; terminada es de uso interno. */
+typedef struct _pool_tarea {
+    void (*funcion)(void* arg);
+    void* arg;
+    int terminada;
+} pool_tarea;
+
+/* Crea un Pool para ejecutar tareas en hilos hilos: hilos - 1 hilos
+   propios y el que llama, que ayuda mientras espera en
+   pool_esperar_tarea() o pool_esperar().
+
+   Cada hilo tiene su propia cola de tareas. Las tareas se reparten entre
+   las colas al agregarlas, cada hilo saca de la suya la ultima que
+   entro, y el que se queda sin tareas le roba a otro la primera.
+
+   Sin hilos POSIX (o con hilos <= 1) no crea hilos: las tareas se
+   ejecutan en el que llama.
+
+   Retorna NULL si falla.
+*/
+Pool pool_crear(int hilos);
+
+/* Agrega una tarea: algun hilo llamara t->funcion(t->arg). */
+void pool_agregar(Pool p, pool_tarea* t);
+
+/* Espera a que termine la tarea t (agregada antes con pool_agregar()),
+   ejecutando otras tareas mientras tanto. */
+void pool_esperar_tarea(Pool p, pool_tarea* t);
+
+/* Espera a que terminen todas las tareas agregadas. */
+void pool_esperar(Pool p);
+
+/* Espera a que terminen todas las tareas y destruye el Pool. */
+void pool_destruir(Pool p);
+
+#endif
@@ -1,59 +1,80 @@
-#ifndef DEFINE_PQ_H
-#define DEFINE_PQ_H
-
-/*Definicion del API de la cola de prioridades, la implementacion va en pq.c*/
-
-/* macros de definicion de tipos de datos boolean */
-#define TRUE 1
-#define FALSE 0
-#define BOOLEAN int
-
-/* Implementacion de una cola de prioridades usando un Monticulo (Heap) */
-
-/* PrioValue es un contenedor para almacenar la combinacion de Prioridad+Valor dentro del arreglo*/
-typedef struct _PrioValue {
-	int prio;
-	void* value;
-}*PrioValue;
-
-/*Heap es la estructura que contiene el arreglo (de PrioValues), la capacidad del arreglo y el tamano del monticulo */
-typedef struct Heap {
-	PrioValue* arr;
-	int cap;
-	int size;
-}*PQ;
-
-
-/* Crea la cola de prioridad e inicializa sus atributos
-retorna un puntero a la cola de prioridad
-retorna NULL si hubo error*/
-PQ pq_create();
-
-
-/*
-  Agrega un valor a la cola con la prioridad dada
-  
-  retorna TRUE si tuvo exito, FALSE si no
-*/
-BOOLEAN pq_add(PQ pq, void* valor, int prioridad);
-
-/*
-Saca el valor de menor prioridad (cima del monticulo) y lo guarda en la posicion retVal (paso por referencia)
-retorna FALSE si tiene un error
-retorna TRUE si tuvo EXITO
-*/
-BOOLEAN pq_remove(PQ pq, void** retVal);
-
-/* retorna el tamao de la cola de prioridad,
-retorna 0 si hubo error
-*/
-int pq_size(PQ pq);
-
-/* Destruye la cola de prioridad,
-retorna TRUE si tuvo exito
-retorna FALSE si tuvo error*/
-BOOLEAN pq_destroy(PQ pq);
-
-
-#endif
-
+#ifndef DEFINE_PQ_H
+#define DEFINE_PQ_H
+
+/*Definicion del API de la cola de prioridades, la implementacion va en pq.c*/
+
+/* macros de definicion de tipos de datos boolean */
+#define TRUE 1
+#define FALSE 0
+#define BOOLEAN int
+
+/* Implementacion de una cola de prioridades usando un Monticulo (Heap) d-ario */
+
+/* Cantidad de hijos de cada nodo del monticulo */
+#define PQ_ARIDAD 4
+
+/* PrioValue es un contenedor para almacenar la combinacion de Prioridad+Valor dentro del arreglo*/
+typedef struct _PrioValue {
+	int prio;
+	void* value;
+}*PrioValue;
+
+/*Heap es la estructura que contiene el arreglo (de PrioValues, guardados uno
+al lado del otro en posiciones 0..size-1), la capacidad del arreglo y el tamano del monticulo */
+typedef struct Heap {
+	struct _PrioValue* arr;
+	int cap;
+	int size;
+}*PQ;
+
+
+/* Crea la cola de prioridad e inicializa sus atributos
+retorna un puntero a la cola de prioridad
+retorna NULL si hubo error*/
+PQ pq_create();
+
+
+/*
+  Agrega un valor a la cola con la prioridad dada
+  
+  retorna TRUE si tuvo exito, FALSE si no
+*/
+BOOLEAN pq_add(PQ pq, void* valor, int prioridad);
+
+/*
+  Agrega de una vez los n elementos de items (un arreglo de struct _PrioValue)
+  y reconstruye el monticulo en tiempo O(n), mas rapido que n llamadas a pq_add
+  
+  retorna TRUE si tuvo exito, FALSE si no
+*/
+BOOLEAN pq_build(PQ pq, const struct _PrioValue* items, int n);
+
+/*
+Saca el valor de menor prioridad (cima del monticulo) y lo guarda en la posicion retVal (paso por referencia)
+retorna FALSE si tiene un error
+retorna TRUE si tuvo EXITO
+*/
+BOOLEAN pq_remove(PQ pq, void** retVal);
+
+/*
+Saca el valor de menor prioridad (lo guarda en retVal) y agrega valor con la
+prioridad dada, reacomodando el monticulo una sola vez.
+Equivale a pq_remove() seguido de pq_add(), pero es mas rapido.
+retorna FALSE si tiene un error (por ejemplo si la cola esta vacia)
+retorna TRUE si tuvo EXITO
+*/
+BOOLEAN pq_remove_add(PQ pq, void** retVal, void* valor, int prioridad);
+
+/* retorna el tamao de la cola de prioridad,
+retorna 0 si hubo error
+*/
+int pq_size(PQ pq);
+
+/* Destruye la cola de prioridad,
+retorna TRUE si tuvo exito
+retorna FALSE si tuvo error*/
+BOOLEAN pq_destroy(PQ pq);
+
+
+#endif
+